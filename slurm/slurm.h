@@ -3216,6 +3216,12 @@ typedef struct stats_info_response_msg {
 	uint32_t agent_count;
 	uint32_t agent_thread_count;
 	uint32_t dbd_agent_queue_size;
+	uint32_t dbd_agent_queue_max;
+	uint32_t dbd_agent_discarded;
+	uint32_t dbd_agent_batches;
+	uint32_t dbd_agent_latency_last;
+	uint32_t dbd_agent_latency_max;
+	uint64_t dbd_agent_latency_sum;
 	uint32_t gettimeofday_latency;
 
 	uint32_t schedule_cycle_max;
@@ -3226,6 +3232,7 @@ typedef struct stats_info_response_msg {
 	uint32_t *schedule_exit;
 	uint32_t schedule_exit_cnt;
 	uint32_t schedule_queue_len;
+	uint32_t schedule_shape_hits;
 
 	uint32_t jobs_submitted;
 	uint32_t jobs_started;
@@ -3252,11 +3259,19 @@ typedef struct stats_info_response_msg {
 	uint32_t bf_depth_try_sum;
 	uint32_t bf_queue_len;
 	uint32_t bf_queue_len_sum;
+	uint32_t bf_shape_hits;
 	uint32_t bf_table_size;
 	uint32_t bf_table_size_sum;
 	time_t   bf_when_last_cycle;
 	uint32_t bf_active;
 
+	uint32_t decay_cycle_counter;
+	uint32_t decay_cycle_last;
+	uint32_t decay_cycle_max;
+	uint64_t decay_cycle_sum;
+	uint32_t decay_jobs_calc;
+	uint32_t decay_jobs_skipped;
+
 	uint32_t rpc_type_size;
 	uint16_t *rpc_type_id;
 	uint32_t *rpc_type_cnt;
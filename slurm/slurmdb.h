@@ -259,6 +259,10 @@ enum cluster_fed_states {
 #define DB_CONN_FLAG_CLUSTER_DEL SLURM_BIT(0)
 #define DB_CONN_FLAG_ROLLBACK SLURM_BIT(1)
 #define DB_CONN_FLAG_FEDUPDATE SLURM_BIT(2)
+#define DB_CONN_FLAG_BULK SLURM_BIT(3) /* queue rows for multi-row inserts */
+#define DB_CONN_FLAG_READ_ONLY SLURM_BIT(4) /* connection to a read replica */
+#define DB_CONN_FLAG_DIRTY SLURM_BIT(5) /* writes not committed yet */
+#define DB_CONN_FLAG_REPLICA_READ SLURM_BIT(6) /* last read went to replica */
 
 /********************************************/
 
@@ -331,6 +335,10 @@ typedef struct {
 	List jobname_list;	/* list of char * */
 	uint32_t nodes_max;     /* number of nodes high range */
 	uint32_t nodes_min;     /* number of nodes low range */
+	char *page_cluster;     /* continue a paged query after page_job_id
+				 * on this cluster, NULL for first page */
+	uint32_t page_job_id;   /* last job id of the previous page */
+	uint32_t page_size;     /* max jobs per reply, 0 for all */
 	List partition_list;	/* list of char * */
 	List qos_list;  	/* list of char * */
 	List reason_list;	/* list of char * */
@@ -913,6 +921,8 @@ typedef struct {
 				 * (DON'T PACK for state file) */
 	List acct_limit_list; /* slurmdb_used_limits_t's (DON'T PACK
 			       * for state file) */
+	void *acct_limit_hash; /* xhash_t of acct_limit_list by acct
+				* (DON'T PACK) */
 	List job_list; /* list of job pointers to submitted/running
 			  jobs (DON'T PACK) */
 	bitstr_t *grp_node_bitmap;	/* Bitmap of allocated nodes
@@ -938,6 +948,8 @@ typedef struct {
 	long double *usage_tres_raw; /* measure of each TRES usage */
 	List user_limit_list; /* slurmdb_used_limits_t's (DON'T PACK
 			       * for state file) */
+	void *user_limit_hash; /* xhash_t of user_limit_list by uid
+				* (DON'T PACK) */
 } slurmdb_qos_usage_t;
 
 typedef struct {
@@ -1410,6 +1422,9 @@ typedef struct {
 
 typedef struct {
 	slurmdb_rollup_stats_t *dbd_rollup_stats;
+	uint32_t query_cache_entries;   /* replies in the query cache */
+	uint64_t query_cache_hits;      /* queries answered from the cache */
+	uint64_t query_cache_misses;    /* cacheable queries not in it */
 	List rollup_stats;              /* List of Clusters rollup stats */
 	List rpc_list;                  /* list of RPCs sent to the dbd. */
 	time_t time_start;              /* When we started collecting data */
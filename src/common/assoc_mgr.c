@@ -45,13 +45,14 @@
 #include <ctype.h>
 
 #include "src/common/uid.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 #include "src/interfaces/priority.h"
 #include "src/common/slurmdbd_pack.h"
 #include "src/slurmdbd/read_config.h"
 
-#define ASSOC_HASH_SIZE 1000
-#define ASSOC_HASH_ID_INX(_assoc_id)	(_assoc_id % ASSOC_HASH_SIZE)
+#define ASSOC_HASH_SIZE 1024	/* initial size, grows with association count */
+#define ASSOC_HASH_ID_INX(_assoc_id)	(_assoc_id % assoc_hash_size)
 
 typedef struct {
 	char *req;
@@ -65,6 +66,13 @@ typedef struct {
 	uint64_t **tres_cnt;
 } foreach_tres_pos_t;
 
+/* Entry of the user and QOS indexes, by id or by lower case name */
+typedef struct {
+	uint32_t id;
+	char *name;
+	void *rec;
+} index_rec_t;
+
 slurmdb_assoc_rec_t *assoc_mgr_root_assoc = NULL;
 uint32_t g_qos_max_priority = 0;
 uint32_t g_assoc_max_priority = 0;
@@ -89,6 +97,12 @@ static pthread_mutex_t assoc_lock_init = PTHREAD_MUTEX_INITIALIZER;
 static assoc_init_args_t init_setup;
 static slurmdb_assoc_rec_t **assoc_hash_id = NULL;
 static slurmdb_assoc_rec_t **assoc_hash = NULL;
+static uint32_t assoc_hash_size = ASSOC_HASH_SIZE;
+static uint32_t assoc_hash_cnt = 0;
+static xhash_t *qos_index_id = NULL;
+static xhash_t *qos_index_name = NULL;
+static xhash_t *user_index_name = NULL;
+static xhash_t *user_index_uid = NULL;
 static int *assoc_mgr_tres_old_pos = NULL;
 
 static bool _running_cache(void)
@@ -100,66 +114,311 @@ static bool _running_cache(void)
 	return false;
 }
 
-static int _get_str_inx(char *name)
+/* Case insensitive FNV-1a hash of name, continuing from hash */
+static uint32_t _get_str_inx(uint32_t hash, char *name)
 {
-	int j, index = 0;
-
 	if (!name)
-		return 0;
+		return hash;
 
-	for (j = 1; *name; name++, j++)
-		index += (int)tolower(*name) * j;
+	for (; *name; name++) {
+		hash ^= (uint32_t) tolower(*name);
+		hash *= 16777619;
+	}
+
+	/* Separate the fields so "ab","c" and "a","bc" differ */
+	hash ^= 0xff;
+	hash *= 16777619;
 
-	return index;
+	return hash;
 }
 
-static int _assoc_hash_index(slurmdb_assoc_rec_t *assoc)
+static uint32_t _assoc_hash_index(slurmdb_assoc_rec_t *assoc)
 {
-	int index;
+	uint32_t index = 2166136261U;
 
 	xassert(assoc);
 
-	/* Multiply each character by its numerical position in the
-	 * name string to add a bit of entropy.
-	 */
-
-	index = assoc->uid;
+	index ^= assoc->uid;
+	index *= 16777619;
 
 	/* only set on the slurmdbd */
 	if (slurmdbd_conf && assoc->cluster)
-		index += _get_str_inx(assoc->cluster);
+		index = _get_str_inx(index, assoc->cluster);
 
 	if (assoc->acct)
-		index += _get_str_inx(assoc->acct);
+		index = _get_str_inx(index, assoc->acct);
 
 	if (assoc->partition)
-		index += _get_str_inx(assoc->partition);
+		index = _get_str_inx(index, assoc->partition);
 
-	index %= ASSOC_HASH_SIZE;
-	if (index < 0)
-		index += ASSOC_HASH_SIZE;
+	return index % assoc_hash_size;
+}
 
-	return index;
+static void _free_assoc_hash(void)
+{
+	xfree(assoc_hash_id);
+	xfree(assoc_hash);
+	assoc_hash_size = ASSOC_HASH_SIZE;
+	assoc_hash_cnt = 0;
+}
 
+static void _add_assoc_hash(slurmdb_assoc_rec_t *assoc);
+
+/*
+ * Grow the hash tables so chains stay short with hundreds of thousands of
+ * associations. Every record is added again with the new table size.
+ */
+static void _resize_assoc_hash(void)
+{
+	slurmdb_assoc_rec_t **old_hash_id = assoc_hash_id;
+	uint32_t old_size = assoc_hash_size;
+
+	xfree(assoc_hash);
+	assoc_hash_id = NULL;
+	assoc_hash_size *= 4;
+	assoc_hash_cnt = 0;
+
+	debug2("%s: resizing association hash to %u",
+	       __func__, assoc_hash_size);
+
+	for (int i = 0; i < old_size; i++) {
+		slurmdb_assoc_rec_t *assoc = old_hash_id[i];
+
+		while (assoc) {
+			slurmdb_assoc_rec_t *next = assoc->assoc_next_id;
+
+			_add_assoc_hash(assoc);
+			assoc = next;
+		}
+	}
+	xfree(old_hash_id);
 }
 
 static void _add_assoc_hash(slurmdb_assoc_rec_t *assoc)
 {
-	int inx = ASSOC_HASH_ID_INX(assoc->id);
+	int inx;
+
+	if (assoc_hash_id && (assoc_hash_cnt >= (assoc_hash_size * 2)))
+		_resize_assoc_hash();
 
 	if (!assoc_hash_id)
-		assoc_hash_id = xcalloc(ASSOC_HASH_SIZE,
+		assoc_hash_id = xcalloc(assoc_hash_size,
 					sizeof(slurmdb_assoc_rec_t *));
 	if (!assoc_hash)
-		assoc_hash = xcalloc(ASSOC_HASH_SIZE,
+		assoc_hash = xcalloc(assoc_hash_size,
 				     sizeof(slurmdb_assoc_rec_t *));
 
+	inx = ASSOC_HASH_ID_INX(assoc->id);
 	assoc->assoc_next_id = assoc_hash_id[inx];
 	assoc_hash_id[inx] = assoc;
 
 	inx = _assoc_hash_index(assoc);
 	assoc->assoc_next = assoc_hash[inx];
 	assoc_hash[inx] = assoc;
+
+	assoc_hash_cnt++;
+}
+
+static void _index_rec_id(void *item, const char **key, uint32_t *key_len)
+{
+	index_rec_t *index_rec = item;
+
+	if (index_rec->name) {
+		*key = index_rec->name;
+		*key_len = strlen(index_rec->name);
+	} else {
+		*key = (char *) &index_rec->id;
+		*key_len = sizeof(index_rec->id);
+	}
+}
+
+static void _index_rec_free(void *item)
+{
+	index_rec_t *index_rec = item;
+
+	xfree(index_rec->name);
+	xfree(index_rec);
+}
+
+/* Add rec to an index by id, keeping the first record with a given id */
+static void _index_add_id(xhash_t *index, uint32_t id, void *rec)
+{
+	index_rec_t *index_rec;
+
+	if (xhash_get(index, (char *) &id, sizeof(id)))
+		return;
+
+	index_rec = xmalloc(sizeof(*index_rec));
+	index_rec->id = id;
+	index_rec->rec = rec;
+	xhash_add(index, index_rec);
+}
+
+/* Add rec to an index by name, keeping the first record with a given name */
+static void _index_add_name(xhash_t *index, char *name, void *rec)
+{
+	index_rec_t *index_rec;
+	char *key;
+
+	if (!name)
+		return;
+
+	key = xstrdup(name);
+	xstrtolower(key);
+	if (xhash_get_str(index, key)) {
+		xfree(key);
+		return;
+	}
+
+	index_rec = xmalloc(sizeof(*index_rec));
+	index_rec->name = key;
+	index_rec->rec = rec;
+	xhash_add(index, index_rec);
+}
+
+static void *_index_find_id(xhash_t *index, uint32_t id)
+{
+	index_rec_t *index_rec = xhash_get(index, (char *) &id, sizeof(id));
+
+	return index_rec ? index_rec->rec : NULL;
+}
+
+static void *_index_find_name(xhash_t *index, char *name)
+{
+	index_rec_t *index_rec;
+	char *key;
+
+	if (!name)
+		return NULL;
+
+	key = xstrdup(name);
+	xstrtolower(key);
+	index_rec = xhash_get_str(index, key);
+	xfree(key);
+
+	return index_rec ? index_rec->rec : NULL;
+}
+
+/* Remove the entry for id from an index if it points to rec */
+static bool _index_del_id(xhash_t *index, uint32_t id, void *rec)
+{
+	if (_index_find_id(index, id) != rec)
+		return false;
+
+	xhash_delete(index, (char *) &id, sizeof(id));
+	return true;
+}
+
+/* Remove the entry for name from an index if it points to rec */
+static bool _index_del_name(xhash_t *index, char *name, void *rec)
+{
+	char *key;
+
+	if (!name || (_index_find_name(index, name) != rec))
+		return false;
+
+	key = xstrdup(name);
+	xstrtolower(key);
+	xhash_delete_str(index, key);
+	xfree(key);
+	return true;
+}
+
+/*
+ * Rebuild the user indexes from user_list. Must be called with the user
+ * write lock whenever the whole user list is replaced.
+ */
+static void _build_user_index(List user_list)
+{
+	slurmdb_user_rec_t *user;
+	list_itr_t *itr;
+
+	xhash_free(user_index_name);
+	xhash_free(user_index_uid);
+
+	if (!user_list)
+		return;
+
+	user_index_name = xhash_init(_index_rec_id, _index_rec_free);
+	user_index_uid = xhash_init(_index_rec_id, _index_rec_free);
+
+	itr = list_iterator_create(user_list);
+	while ((user = list_next(itr))) {
+		if (user->uid != NO_VAL)
+			_index_add_id(user_index_uid, user->uid, user);
+		_index_add_name(user_index_name, user->name, user);
+	}
+	list_iterator_destroy(itr);
+}
+
+/* Add a user to the user indexes. Must be called with the user write lock. */
+static void _user_index_add(slurmdb_user_rec_t *user)
+{
+	if (!user_index_uid || !user_index_name)
+		return;
+
+	if (user->uid != NO_VAL)
+		_index_add_id(user_index_uid, user->uid, user);
+	_index_add_name(user_index_name, user->name, user);
+}
+
+/*
+ * Remove a user from the user indexes before it is freed or its name or uid
+ * changes. Another user with the same uid or name is indexed in its place, as
+ * a rebuild would. Must be called with the user write lock.
+ */
+static void _user_index_remove(slurmdb_user_rec_t *user)
+{
+	slurmdb_user_rec_t *other;
+	list_itr_t *itr;
+	bool uid_gone, name_gone;
+
+	if (!user_index_uid || !user_index_name)
+		return;
+
+	uid_gone = (user->uid != NO_VAL) &&
+		_index_del_id(user_index_uid, user->uid, user);
+	name_gone = _index_del_name(user_index_name, user->name, user);
+
+	if ((!uid_gone && !name_gone) || !assoc_mgr_user_list)
+		return;
+
+	itr = list_iterator_create(assoc_mgr_user_list);
+	while ((other = list_next(itr))) {
+		if (other == user)
+			continue;
+		if (uid_gone && (other->uid == user->uid))
+			_index_add_id(user_index_uid, other->uid, other);
+		if (name_gone && !xstrcasecmp(other->name, user->name))
+			_index_add_name(user_index_name, other->name, other);
+	}
+	list_iterator_destroy(itr);
+}
+
+/*
+ * Rebuild the QOS indexes from qos_list. Must be called with the QOS write
+ * lock whenever QOS are added or removed.
+ */
+static void _build_qos_index(List qos_list)
+{
+	slurmdb_qos_rec_t *qos;
+	list_itr_t *itr;
+
+	xhash_free(qos_index_id);
+	xhash_free(qos_index_name);
+
+	if (!qos_list)
+		return;
+
+	qos_index_id = xhash_init(_index_rec_id, _index_rec_free);
+	qos_index_name = xhash_init(_index_rec_id, _index_rec_free);
+
+	itr = list_iterator_create(qos_list);
+	while ((qos = list_next(itr))) {
+		_index_add_id(qos_index_id, qos->id, qos);
+		_index_add_name(qos_index_name, qos->name, qos);
+	}
+	list_iterator_destroy(itr);
 }
 
 static slurmdb_assoc_rec_t *_find_assoc_rec_id(uint32_t assoc_id,
@@ -330,6 +589,8 @@ static void _delete_assoc_hash(slurmdb_assoc_rec_t *assoc)
 		return;	/* Fix CLANG false positive error */
 	} else
 		*assoc_pptr = assoc_ptr->assoc_next;
+
+	assoc_hash_cnt--;
 }
 
 
@@ -703,6 +964,29 @@ static int _list_find_user(void *x, void *key)
 	return 0;
 }
 
+/* Find a user by uid, the user lock must be held */
+static slurmdb_user_rec_t *_find_user_uid(uint32_t uid)
+{
+	if (user_index_uid)
+		return _index_find_id(user_index_uid, uid);
+
+	return list_find_first_ro(assoc_mgr_user_list, _list_find_uid, &uid);
+}
+
+/*
+ * Find a user by uid if set, otherwise by name. The user lock must be held.
+ */
+static slurmdb_user_rec_t *_find_user(slurmdb_user_rec_t *user)
+{
+	if (!user_index_uid || !user_index_name)
+		return list_find_first_ro(assoc_mgr_user_list,
+					  _list_find_user, user);
+	if (user->uid != NO_VAL)
+		return _index_find_id(user_index_uid, user->uid);
+
+	return _index_find_name(user_index_name, user->name);
+}
+
 static int _list_find_coord(void *x, void *key)
 {
 	slurmdb_user_rec_t *user = x;
@@ -736,8 +1020,7 @@ static void _set_user_default_acct(slurmdb_assoc_rec_t *assoc,
 	/* set up the default if this is it */
 	if ((assoc->is_def == 1) && (assoc->uid != NO_VAL)) {
 		if (!user)
-			user = list_find_first(assoc_mgr_user_list,
-					       _list_find_uid, &assoc->uid);
+			user = _find_user_uid(assoc->uid);
 
 		if (!user)
 			return;
@@ -767,8 +1050,7 @@ static void _clear_user_default_acct(slurmdb_assoc_rec_t *assoc)
 
 	/* set up the default if this is it */
 	if ((assoc->is_def == 0) && (assoc->uid != NO_VAL)) {
-		slurmdb_user_rec_t *user = list_find_first(
-			assoc_mgr_user_list, _list_find_uid, &assoc->uid);
+		slurmdb_user_rec_t *user = _find_user_uid(assoc->uid);
 
 		if (!user)
 			return;
@@ -795,8 +1077,7 @@ static void _set_user_default_wckey(slurmdb_wckey_rec_t *wckey,
 	/* set up the default if this is it */
 	if ((wckey->is_def == 1) && (wckey->uid != NO_VAL)) {
 		if (!user)
-			user = list_find_first(assoc_mgr_user_list,
-					       _list_find_uid, &wckey->uid);
+			user = _find_user_uid(wckey->uid);
 
 		if (!user)
 			return;
@@ -1100,8 +1381,7 @@ static int _post_assoc_list(void)
 	if (!assoc_mgr_assoc_list)
 		return SLURM_ERROR;
 
-	xfree(assoc_hash_id);
-	xfree(assoc_hash);
+	_free_assoc_hash();
 
 	itr = list_iterator_create(assoc_mgr_assoc_list);
 
@@ -1238,6 +1518,8 @@ static int _post_qos_list(List qos_list)
 	}
 	list_iterator_destroy(itr);
 
+	_build_qos_index(qos_list);
+
 	return SLURM_SUCCESS;
 }
 
@@ -1751,6 +2033,7 @@ static int _get_assoc_mgr_user_list(void *db_conn, int enforce)
 	assoc_mgr_user_list = acct_storage_g_get_users(db_conn, uid, &user_q);
 
 	if (!assoc_mgr_user_list) {
+		_build_user_index(NULL);
 		assoc_mgr_unlock(&locks);
 		if (enforce & ACCOUNTING_ENFORCE_ASSOCS) {
 			error("%s: no list was made.", __func__);
@@ -1761,6 +2044,7 @@ static int _get_assoc_mgr_user_list(void *db_conn, int enforce)
 	}
 
 	_post_user_list(assoc_mgr_user_list);
+	_build_user_index(assoc_mgr_user_list);
 
 	assoc_mgr_unlock(&locks);
 	return SLURM_SUCCESS;
@@ -2013,6 +2297,7 @@ static int _refresh_assoc_mgr_user_list(void *db_conn, int enforce)
 	FREE_NULL_LIST(assoc_mgr_user_list);
 
 	assoc_mgr_user_list = current_users;
+	_build_user_index(assoc_mgr_user_list);
 
 	assoc_mgr_unlock(&locks);
 
@@ -2177,8 +2462,9 @@ extern int assoc_mgr_fini(bool save_state)
 	if (_running_cache())
 		*init_setup.running_cache = RUNNING_CACHE_STATE_NOTRUNNING;
 
-	xfree(assoc_hash_id);
-	xfree(assoc_hash);
+	_free_assoc_hash();
+	_build_qos_index(NULL);
+	_build_user_index(NULL);
 
 	assoc_mgr_unlock(&locks);
 
@@ -2208,8 +2494,7 @@ static slurmdb_admin_level_t _get_admin_level_internal(void *db_conn,
 		return SLURMDB_ADMIN_NOTSET;
 	}
 
-	found_user = list_find_first_ro(assoc_mgr_user_list,
-					_list_find_uid, &uid);
+	found_user = _find_user_uid(uid);
 
 	if (found_user)
 		level = found_user->admin_level;
@@ -2874,8 +3159,7 @@ extern int assoc_mgr_fill_in_user(void *db_conn, slurmdb_user_rec_t *user,
 		return SLURM_SUCCESS;
 	}
 
-	if (!(found_user = list_find_first_ro(assoc_mgr_user_list,
-					      _list_find_user, user))) {
+	if (!(found_user = _find_user(user))) {
 		if (!locked)
 			assoc_mgr_unlock(&locks);
 		if (enforce & ACCOUNTING_ENFORCE_ASSOCS)
@@ -2954,14 +3238,21 @@ extern int assoc_mgr_fill_in_qos(void *db_conn, slurmdb_qos_rec_t *qos,
 		return SLURM_SUCCESS;
 	}
 
-	itr = list_iterator_create(assoc_mgr_qos_list);
-	while ((found_qos = list_next(itr))) {
-		if (qos->id == found_qos->id)
-			break;
-		else if (qos->name && !xstrcasecmp(qos->name, found_qos->name))
-			break;
+	if (qos_index_id && qos_index_name) {
+		if (!(found_qos = _index_find_id(qos_index_id, qos->id)))
+			found_qos = _index_find_name(qos_index_name,
+						     qos->name);
+	} else {
+		itr = list_iterator_create(assoc_mgr_qos_list);
+		while ((found_qos = list_next(itr))) {
+			if (qos->id == found_qos->id)
+				break;
+			else if (qos->name &&
+				 !xstrcasecmp(qos->name, found_qos->name))
+				break;
+		}
+		list_iterator_destroy(itr);
 	}
-	list_iterator_destroy(itr);
 
 	if (!found_qos) {
 		if (!locked)
@@ -3908,6 +4199,48 @@ extern int assoc_mgr_update(List update_list, bool locked)
 	return rc;
 }
 
+static int _find_deleted_assoc(void *x, void *key)
+{
+	slurmdb_assoc_rec_t *assoc = x;
+
+	return (assoc->flags & ASSOC_FLAG_DELETED) ? 1 : 0;
+}
+
+/*
+ * Unlink the associations in remove_list, marked with ASSOC_FLAG_DELETED,
+ * from assoc_mgr_assoc_list and from their parents' children_list. Each
+ * list is only walked once however many of its records were removed.
+ */
+static void _remove_deleted_assocs(List remove_list)
+{
+	slurmdb_assoc_rec_t *rec, *parent;
+	List parent_list = list_create(NULL);
+	list_itr_t *itr;
+
+	itr = list_iterator_create(remove_list);
+	while ((rec = list_next(itr))) {
+		parent = rec->usage->parent_assoc_ptr;
+		if (!parent || !parent->usage->children_list ||
+		    list_find_first(parent_list, slurm_find_ptr_in_list,
+				    parent))
+			continue;
+		list_append(parent_list, parent);
+		/* children_list does not own its records */
+		(void) list_delete_all(parent->usage->children_list,
+				       _find_deleted_assoc, NULL);
+	}
+	list_iterator_destroy(itr);
+	FREE_NULL_LIST(parent_list);
+
+	/* remove_list now owns the records, don't destroy them here */
+	itr = list_iterator_create(assoc_mgr_assoc_list);
+	while ((rec = list_next(itr))) {
+		if (rec->flags & ASSOC_FLAG_DELETED)
+			(void) list_remove(itr);
+	}
+	list_iterator_destroy(itr);
+}
+
 extern int assoc_mgr_update_assocs(slurmdb_update_object_t *update, bool locked)
 {
 	slurmdb_assoc_rec_t * rec = NULL;
@@ -4247,6 +4580,7 @@ extern int assoc_mgr_update_assocs(slurmdb_update_object_t *update, bool locked)
 
 			/* Set something so we know to add it to the hash */
 			object->uid = INFINITE;
+			object->flags &= ~ASSOC_FLAG_DELETED;
 
 			assoc_mgr_set_assoc_tres_cnt(object);
 
@@ -4301,19 +4635,6 @@ extern int assoc_mgr_update_assocs(slurmdb_update_object_t *update, bool locked)
 
 			_remove_nondirect_coord_acct(rec);
 
-			/*
-			 * Remove the pointer from the children_list or
-			 * any call removing a parent could get an illegal read
-			 * when _remove_nondirect_coord_acct() is called and
-			 * this rec is still in it's children_list.
-			 */
-			if (rec->usage->parent_assoc_ptr &&
-			    rec->usage->parent_assoc_ptr->
-			    usage->children_list)
-				list_delete_first(rec->usage->parent_assoc_ptr->
-						  usage->children_list,
-						  slurm_find_ptr_in_list, rec);
-
 			/*
 			 * If the root assoc has been removed we need to clear
 			 * the short cut pointer.
@@ -4321,20 +4642,21 @@ extern int assoc_mgr_update_assocs(slurmdb_update_object_t *update, bool locked)
 			if (rec == assoc_mgr_root_assoc)
 				assoc_mgr_root_assoc = NULL;
 
+			/*
+			 * Only mark the record here. It is removed from
+			 * assoc_mgr_assoc_list and its parent's children_list
+			 * once all the objects are processed, so removing
+			 * many associations walks those lists once instead of
+			 * once per association. Until then the record is
+			 * kept so _remove_nondirect_coord_acct() can still
+			 * read it through its parent's children_list.
+			 */
 			_delete_assoc_hash(rec);
-			list_remove_first(assoc_mgr_assoc_list,
-					  slurm_find_ptr_in_list, rec);
-			if (init_setup.remove_assoc_notify) {
-				/* since there are some deadlock
-				   issues while inside our lock here
-				   we have to process a notify later
-				*/
-				if (!remove_list)
-					remove_list = list_create(
-						slurmdb_destroy_assoc_rec);
-				list_append(remove_list, rec);
-			} else
-				slurmdb_destroy_assoc_rec(rec);
+			rec->flags |= ASSOC_FLAG_DELETED;
+			if (!remove_list)
+				remove_list = list_create(
+					slurmdb_destroy_assoc_rec);
+			list_append(remove_list, rec);
 			break;
 		case SLURMDB_REMOVE_ASSOC_USAGE:
 			if (!rec) {
@@ -4350,6 +4672,16 @@ extern int assoc_mgr_update_assocs(slurmdb_update_object_t *update, bool locked)
 		slurmdb_destroy_assoc_rec(object);
 	}
 
+	if (remove_list) {
+		_remove_deleted_assocs(remove_list);
+		/*
+		 * Since there are some deadlock issues while inside our lock
+		 * here we have to process a notify later.
+		 */
+		if (!init_setup.remove_assoc_notify)
+			FREE_NULL_LIST(remove_list);
+	}
+
 	if (redo_priority)
 		_calculate_assoc_norm_priorities(redo_priority == 2);
 
@@ -4654,11 +4986,13 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update, bool locked)
 					      rec->name);
 					break;
 				}
+				_user_index_remove(rec);
 				xfree(rec->old_name);
 				rec->old_name = rec->name;
 				rec->name = object->name;
 				object->name = NULL;
 				rc = _change_user_name(rec);
+				_user_index_add(rec);
 			}
 
 			if (object->default_acct) {
@@ -4689,6 +5023,7 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update, bool locked)
 			} else
 				object->uid = pw_uid;
 			list_append(assoc_mgr_user_list, object);
+			_user_index_add(object);
 			_handle_new_user_coord(object);
 			object = NULL;
 			break;
@@ -4699,6 +5034,7 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update, bool locked)
 			}
 			list_delete_first(assoc_mgr_coord_list,
 					  slurm_find_ptr_in_list, rec);
+			_user_index_remove(rec);
 			list_delete_item(itr);
 			break;
 		case SLURMDB_ADD_COORD:
@@ -5174,6 +5510,9 @@ extern int assoc_mgr_update_qos(slurmdb_update_object_t *update, bool locked)
 	} else if (redo_priority == 2)
 		_post_qos_list(assoc_mgr_qos_list);
 
+	/* QOS may have been added or removed whatever the priority did */
+	_build_qos_index(assoc_mgr_qos_list);
+
 	list_iterator_destroy(itr);
 
 	if (!locked)
@@ -6396,6 +6735,7 @@ extern int load_assoc_mgr_state(bool only_tres)
 			FREE_NULL_LIST(assoc_mgr_user_list);
 			assoc_mgr_user_list = msg->my_list;
 			_post_user_list(assoc_mgr_user_list);
+			_build_user_index(assoc_mgr_user_list);
 			debug("Recovered %u users",
 			      list_count(assoc_mgr_user_list));
 			msg->my_list = NULL;
@@ -6590,7 +6930,7 @@ extern void assoc_mgr_set_uid(uid_t uid, char *username)
 		return;
 	}
 
-	if (list_find_first_ro(assoc_mgr_user_list, _list_find_uid, &uid)) {
+	if (_find_user_uid(uid)) {
 		debug2("%s: uid=%u already known", __func__, uid);
 		assoc_mgr_unlock(&read_lock);
 		return;
@@ -6604,8 +6944,7 @@ extern void assoc_mgr_set_uid(uid_t uid, char *username)
 		return;
 	}
 
-	if (!(user = list_find_first(assoc_mgr_user_list, _list_find_user,
-				     &lookup))) {
+	if (!(user = _find_user(&lookup))) {
 		debug2("%s: user %s not in assoc_mgr_user_list",
 		       __func__, username);
 		assoc_mgr_unlock(&write_locks);
@@ -6614,7 +6953,9 @@ extern void assoc_mgr_set_uid(uid_t uid, char *username)
 
 	debug2("%s: adding mapping for user %s uid %u",
 	       __func__, username, uid);
+	_user_index_remove(user);
 	user->uid = uid;
+	_user_index_add(user);
 
 	if (assoc_mgr_assoc_list)
 		list_for_each(assoc_mgr_assoc_list, _each_assoc_set_uid, user);
@@ -6684,6 +7025,7 @@ static int _for_each_user_missing_uids(void *x, void *arg)
 		debug3("%s: found uid %u for user %s",
 		       __func__, pw_uid, object->name);
 		object->uid = pw_uid;
+		_user_index_add(object);
 	}
 
 	return 1;
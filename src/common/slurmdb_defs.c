@@ -47,6 +47,7 @@
 #include "src/interfaces/jobacct_gather.h"
 #include "src/common/slurm_time.h"
 #include "src/common/slurmdb_defs.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 #include "src/slurmdbd/read_config.h"
@@ -704,6 +705,7 @@ extern void slurmdb_destroy_qos_usage(void *object)
 		(slurmdb_qos_usage_t *)object;
 
 	if (usage) {
+		xhash_free_ptr((xhash_t **) &usage->acct_limit_hash);
 		FREE_NULL_LIST(usage->acct_limit_list);
 		FREE_NULL_BITMAP(usage->grp_node_bitmap);
 		xfree(usage->grp_node_job_cnt);
@@ -711,6 +713,7 @@ extern void slurmdb_destroy_qos_usage(void *object)
 		xfree(usage->grp_used_tres);
 		FREE_NULL_LIST(usage->job_list);
 		xfree(usage->usage_tres_raw);
+		xhash_free_ptr((xhash_t **) &usage->user_limit_hash);
 		FREE_NULL_LIST(usage->user_limit_list);
 		xfree(usage);
 	}
@@ -1248,6 +1251,7 @@ extern void slurmdb_destroy_job_cond(void *object)
 		FREE_NULL_LIST(job_cond->constraint_list);
 		FREE_NULL_LIST(job_cond->groupid_list);
 		FREE_NULL_LIST(job_cond->jobname_list);
+		xfree(job_cond->page_cluster);
 		FREE_NULL_LIST(job_cond->partition_list);
 		FREE_NULL_LIST(job_cond->qos_list);
 		FREE_NULL_LIST(job_cond->reason_list);
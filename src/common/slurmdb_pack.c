@@ -4021,6 +4021,11 @@ extern void slurmdb_pack_job_cond(void *in, uint16_t protocol_version,
 			packnull(buffer);	/* used_nodes */
 			pack32(NO_VAL, buffer);	/* count(userid_list) */
 			pack32(NO_VAL, buffer);	/* count(wckey_list) */
+			if (protocol_version >= SLURM_24_08_PROTOCOL_VERSION) {
+				packnull(buffer); /* page_cluster */
+				pack32(0, buffer); /* page_job_id */
+				pack32(0, buffer); /* page_size */
+			}
 			return;
 		}
 
@@ -4062,6 +4067,12 @@ extern void slurmdb_pack_job_cond(void *in, uint16_t protocol_version,
 
 		_pack_list_of_str(object->userid_list, buffer);
 		_pack_list_of_str(object->wckey_list, buffer);
+
+		if (protocol_version >= SLURM_24_08_PROTOCOL_VERSION) {
+			packstr(object->page_cluster, buffer);
+			pack32(object->page_job_id, buffer);
+			pack32(object->page_size, buffer);
+		}
 	}
 }
 
@@ -4302,6 +4313,12 @@ extern int slurmdb_unpack_job_cond(void **object, uint16_t protocol_version,
 				list_append(object_ptr->wckey_list, tmp_info);
 			}
 		}
+
+		if (protocol_version >= SLURM_24_08_PROTOCOL_VERSION) {
+			safe_unpackstr(&object_ptr->page_cluster, buffer);
+			safe_unpack32(&object_ptr->page_job_id, buffer);
+			safe_unpack32(&object_ptr->page_size, buffer);
+		}
 	} else
 		goto unpack_error;
 
@@ -5720,6 +5737,12 @@ extern void slurmdb_pack_stats_msg(void *object, uint16_t protocol_version,
 		slurm_pack_list(stats_ptr->user_list,
 				slurmdb_pack_rpc_obj,
 				buffer, protocol_version);
+
+		if (protocol_version >= SLURM_24_08_PROTOCOL_VERSION) {
+			pack32(stats_ptr->query_cache_entries, buffer);
+			pack64(stats_ptr->query_cache_hits, buffer);
+			pack64(stats_ptr->query_cache_misses, buffer);
+		}
 	} else {
 		error("%s: protocol_version %hu not supported",
 		      __func__, protocol_version);
@@ -5762,6 +5785,12 @@ extern int slurmdb_unpack_stats_msg(void **object, uint16_t protocol_version,
 				      buffer, protocol_version)
 		    != SLURM_SUCCESS)
 			goto unpack_error;
+
+		if (protocol_version >= SLURM_24_08_PROTOCOL_VERSION) {
+			safe_unpack32(&stats_ptr->query_cache_entries, buffer);
+			safe_unpack64(&stats_ptr->query_cache_hits, buffer);
+			safe_unpack64(&stats_ptr->query_cache_misses, buffer);
+		}
 	} else {
 		error("%s: protocol_version %hu not supported",
 		      __func__, protocol_version);
@@ -212,6 +212,46 @@ end_it:
 	return rc;
 }
 
+/* Max rows and size of one multi-row INSERT from mysql_db_bulk_add() */
+#define BULK_MAX_ROWS 500
+#define BULK_MAX_SIZE (1024 * 1024)
+
+/*
+ * Note a write made in an open transaction. Until it is committed or rolled
+ * back only this connection sees it, so reads must not go to a replica.
+ * With autocommit the write is committed right away.
+ * NOTE: Ensure that mysql_conn->lock is set on function entry
+ */
+static void _mark_dirty(mysql_conn_t *mysql_conn)
+{
+	if (mysql_conn->flags & DB_CONN_FLAG_ROLLBACK)
+		mysql_conn->flags |= DB_CONN_FLAG_DIRTY;
+}
+
+/* NOTE: Ensure that mysql_conn->lock is set on function entry */
+static void _bulk_discard(mysql_conn_t *mysql_conn)
+{
+	xfree(mysql_conn->bulk_query);
+	xfree(mysql_conn->bulk_prefix);
+	xfree(mysql_conn->bulk_suffix);
+	mysql_conn->bulk_cnt = 0;
+}
+
+/* NOTE: Ensure that mysql_conn->lock is set on function entry */
+static void _bulk_flush(mysql_conn_t *mysql_conn)
+{
+	if (!mysql_conn->bulk_query)
+		return;
+
+	xstrcat(mysql_conn->bulk_query, mysql_conn->bulk_suffix);
+	if ((_mysql_query_internal(mysql_conn->db_conn,
+				   mysql_conn->bulk_query) != SLURM_SUCCESS) &&
+	    (mysql_conn->bulk_rc == SLURM_SUCCESS))
+		mysql_conn->bulk_rc = SLURM_ERROR;
+
+	_bulk_discard(mysql_conn);
+}
+
 /*
  * Determine if a database server upgrade has taken place and if so, check to
  * see if the candidate table alteration query should be used to alter the table
@@ -718,6 +758,11 @@ void _set_mysql_ssl_opts(MYSQL *db_conn, const char *options)
 			key = val_str;
 		else if (!xstrcasecmp(opt_str, "SSL_CIPHER"))
 			cipher = val_str;
+		else if (!xstrcasecmp(opt_str, "READ_HOST") ||
+			 !xstrcasecmp(opt_str, "READ_PORT") ||
+			 !xstrcasecmp(opt_str, "READ_MAX_LAG") ||
+			 !xstrcasecmp(opt_str, "JOB_PARTITION"))
+			; /* handled by accounting_storage/mysql */
 		else {
 			error("Invalid storage option '%s'", opt_str);
 			goto next;
@@ -814,6 +859,7 @@ extern int destroy_mysql_conn(mysql_conn_t *mysql_conn)
 	if (mysql_conn) {
 		mysql_db_close_db_connection(mysql_conn);
 		xfree(mysql_conn->pre_commit_query);
+		_bulk_discard(mysql_conn);
 		xfree(mysql_conn->cluster_name);
 		slurm_mutex_destroy(&mysql_conn->lock);
 		FREE_NULL_LIST(mysql_conn->update_list);
@@ -860,6 +906,7 @@ extern int destroy_mysql_db_info(mysql_db_info_t *db_info)
 		xfree(db_info->backup);
 		xfree(db_info->host);
 		xfree(db_info->user);
+		xfree(db_info->params);
 		xfree(db_info->pass);
 		xfree(db_info);
 	}
@@ -905,7 +952,8 @@ extern int mysql_db_get_db_connection(mysql_conn_t *mysql_conn, char *db_name,
 			const char *err_str = NULL;
 			int err = mysql_errno(mysql_conn->db_conn);
 
-			if (err == ER_BAD_DB_ERROR) {
+			if ((err == ER_BAD_DB_ERROR) &&
+			    !(mysql_conn->flags & DB_CONN_FLAG_READ_ONLY)) {
 				debug("Database %s not created.  Creating",
 				      db_name);
 				rc = _create_db(db_name, db_info);
@@ -984,6 +1032,8 @@ extern int mysql_db_query(mysql_conn_t *mysql_conn, char *query)
 		return 0;	/* For CLANG false positive */
 	}
 	slurm_mutex_lock(&mysql_conn->lock);
+	_bulk_flush(mysql_conn);
+	_mark_dirty(mysql_conn);
 	rc = _mysql_query_internal(mysql_conn->db_conn, query);
 	slurm_mutex_unlock(&mysql_conn->lock);
 	return rc;
@@ -1002,6 +1052,8 @@ extern int mysql_db_delete_affected_rows(mysql_conn_t *mysql_conn, char *query)
 		return 0;	/* For CLANG false positive */
 	}
 	slurm_mutex_lock(&mysql_conn->lock);
+	_bulk_flush(mysql_conn);
+	_mark_dirty(mysql_conn);
 	if (!(rc = _mysql_query_internal(mysql_conn->db_conn, query)))
 		rc = mysql_affected_rows(mysql_conn->db_conn);
 	slurm_mutex_unlock(&mysql_conn->lock);
@@ -1037,6 +1089,8 @@ extern int mysql_db_commit(mysql_conn_t *mysql_conn)
 		return SLURM_ERROR;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_bulk_flush(mysql_conn);
+	mysql_conn->flags &= ~DB_CONN_FLAG_DIRTY;
 	/* clear out the old results so we don't get a 2014 error */
 	_clear_results(mysql_conn->db_conn);
 	if (mysql_commit(mysql_conn->db_conn)) {
@@ -1058,6 +1112,9 @@ extern int mysql_db_rollback(mysql_conn_t *mysql_conn)
 		return SLURM_ERROR;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	/* Rows still queued belong to the transaction rolled back */
+	_bulk_discard(mysql_conn);
+	mysql_conn->flags &= ~DB_CONN_FLAG_DIRTY;
 	/* clear out the old results so we don't get a 2014 error */
 	_clear_results(mysql_conn->db_conn);
 	if (mysql_rollback(mysql_conn->db_conn)) {
@@ -1084,6 +1141,7 @@ extern MYSQL_RES *mysql_db_query_ret(mysql_conn_t *mysql_conn,
 	MYSQL_RES *result = NULL;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_bulk_flush(mysql_conn);
 	if (_mysql_query_internal(mysql_conn->db_conn, query) != SLURM_ERROR)  {
 		if (mysql_errno(mysql_conn->db_conn) == ER_NO_SUCH_TABLE)
 			goto fini;
@@ -1113,6 +1171,8 @@ extern int mysql_db_query_check_after(mysql_conn_t *mysql_conn, char *query)
 	int rc = SLURM_SUCCESS;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_bulk_flush(mysql_conn);
+	_mark_dirty(mysql_conn);
 	if ((rc = _mysql_query_internal(
 		     mysql_conn->db_conn, query)) != SLURM_ERROR)
 		rc = _clear_results(mysql_conn->db_conn);
@@ -1125,6 +1185,8 @@ extern uint64_t mysql_db_insert_ret_id(mysql_conn_t *mysql_conn, char *query)
 	uint64_t new_id = 0;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_bulk_flush(mysql_conn);
+	_mark_dirty(mysql_conn);
 	if (_mysql_query_internal(mysql_conn->db_conn, query) != SLURM_ERROR)  {
 		new_id = mysql_insert_id(mysql_conn->db_conn);
 		if (!new_id) {
@@ -1138,6 +1200,42 @@ extern uint64_t mysql_db_insert_ret_id(mysql_conn_t *mysql_conn, char *query)
 
 }
 
+extern void mysql_db_bulk_add(mysql_conn_t *mysql_conn, char *prefix,
+			      char *row, char *suffix)
+{
+	slurm_mutex_lock(&mysql_conn->lock);
+	if (mysql_conn->bulk_query &&
+	    (xstrcmp(mysql_conn->bulk_prefix, prefix) ||
+	     xstrcmp(mysql_conn->bulk_suffix, suffix)))
+		_bulk_flush(mysql_conn);
+
+	if (!mysql_conn->bulk_query) {
+		mysql_conn->bulk_prefix = xstrdup(prefix);
+		mysql_conn->bulk_suffix = xstrdup(suffix);
+		xstrfmtcat(mysql_conn->bulk_query, "%s%s", prefix, row);
+	} else
+		xstrfmtcat(mysql_conn->bulk_query, ", %s", row);
+	_mark_dirty(mysql_conn);
+
+	if ((++mysql_conn->bulk_cnt >= BULK_MAX_ROWS) ||
+	    (strlen(mysql_conn->bulk_query) >= BULK_MAX_SIZE))
+		_bulk_flush(mysql_conn);
+	slurm_mutex_unlock(&mysql_conn->lock);
+}
+
+extern int mysql_db_bulk_flush(mysql_conn_t *mysql_conn)
+{
+	int rc;
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	_bulk_flush(mysql_conn);
+	rc = mysql_conn->bulk_rc;
+	mysql_conn->bulk_rc = SLURM_SUCCESS;
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	return rc;
+}
+
 extern int mysql_db_create_table(mysql_conn_t *mysql_conn, char *table_name,
 				 storage_field_t *fields, char *ending)
 {
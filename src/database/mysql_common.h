@@ -64,6 +64,11 @@ typedef struct {
 	uint32_t flags;
 	pthread_mutex_t lock;
 	char *pre_commit_query;
+	char *bulk_query;	/* rows queued by mysql_db_bulk_add() */
+	char *bulk_prefix;	/* "insert into ... values " of bulk_query */
+	char *bulk_suffix;	/* "on duplicate key update ..." or NULL */
+	uint32_t bulk_cnt;	/* rows in bulk_query */
+	int bulk_rc;		/* first error sending queued rows */
 	List update_list;
 	int conn;
 	uint64_t wsrep_trx_fragment_size_orig;
@@ -106,6 +111,25 @@ extern int mysql_db_query_check_after(mysql_conn_t *mysql_conn, char *query);
 
 extern uint64_t mysql_db_insert_ret_id(mysql_conn_t *mysql_conn, char *query);
 
+/*
+ * Queue one row of a multi-row INSERT. Rows sharing prefix and suffix are
+ * sent as a single statement. Queued rows are sent before any other query on
+ * this connection, on commit, when the statement gets large, or by
+ * mysql_db_bulk_flush().
+ * IN prefix - "insert into <table> (<columns>) values "
+ * IN row - "(<values>)"
+ * IN suffix - " on duplicate key update ..." using VALUES(), or NULL
+ */
+extern void mysql_db_bulk_add(mysql_conn_t *mysql_conn, char *prefix,
+			      char *row, char *suffix);
+
+/*
+ * Send queued rows.
+ * RET SLURM_SUCCESS, or SLURM_ERROR if sending any rows queued since the last
+ * call failed
+ */
+extern int mysql_db_bulk_flush(mysql_conn_t *mysql_conn);
+
 extern int mysql_db_create_table(mysql_conn_t *mysql_conn, char *table_name,
 				 storage_field_t *fields, char *ending);
 extern int mysql_db_get_var_str(mysql_conn_t *mysql_conn,
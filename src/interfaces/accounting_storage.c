@@ -62,6 +62,7 @@ typedef struct slurm_acct_storage_ops {
 				    bool rollback, char *cluster_name);
 	int  (*close_conn)         (void **db_conn);
 	int  (*commit)             (void *db_conn, bool commit);
+	int  (*bulk_write)         (void *db_conn, bool enable);
 	int  (*add_users)          (void *db_conn, uint32_t uid,
 				    List user_list);
 	char *(*add_users_cond)    (void *db_conn, uint32_t uid,
@@ -227,6 +228,7 @@ static const char *syms[] = {
 	"acct_storage_p_get_connection",
 	"acct_storage_p_close_connection",
 	"acct_storage_p_commit",
+	"acct_storage_p_bulk_write",
 	"acct_storage_p_add_users",
 	"acct_storage_p_add_users_cond",
 	"acct_storage_p_add_coord",
@@ -406,6 +408,16 @@ extern int acct_storage_g_commit(void *db_conn, bool commit)
 	return (*(ops.commit))(db_conn, commit);
 }
 
+extern int acct_storage_g_bulk_write(void *db_conn, bool enable)
+{
+	xassert(plugin_inited);
+
+	if (plugin_inited == PLUGIN_NOOP)
+		return SLURM_SUCCESS;
+
+	return (*(ops.bulk_write))(db_conn, enable);
+}
+
 extern int acct_storage_g_add_users(void *db_conn, uint32_t uid,
 				    List user_list)
 {
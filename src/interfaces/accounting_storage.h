@@ -52,9 +52,21 @@
 
 typedef enum {
 	ACCT_STORAGE_INFO_CONN_ACTIVE,
-	ACCT_STORAGE_INFO_AGENT_COUNT
+	ACCT_STORAGE_INFO_AGENT_COUNT,
+	ACCT_STORAGE_INFO_AGENT_STATS,	/* acct_storage_agent_stats_t */
+	ACCT_STORAGE_INFO_REPLICA_READ	/* bool, last read used a replica */
 } acct_storage_info_t;
 
+/* Statistics of the slurmctld's queue of messages for the SlurmDBD */
+typedef struct {
+	uint32_t batches;	/* batches acknowledged by the SlurmDBD */
+	uint32_t latency_last;	/* usec from send to reply, last batch */
+	uint32_t latency_max;	/* usec from send to reply, slowest batch */
+	uint64_t latency_sum;	/* usec from send to reply, all batches */
+	uint32_t msgs_discarded; /* messages dropped, queue was full */
+	uint32_t queue_max;	/* deepest the queue has been */
+} acct_storage_agent_stats_t;
+
 extern uid_t db_api_uid;
 
 extern int acct_storage_g_init(void); /* load the plugin */
@@ -89,6 +101,15 @@ extern int acct_storage_g_close_connection(void **db_conn);
  */
 extern int acct_storage_g_commit(void *db_conn, bool commit);
 
+/*
+ * Let the storage group records from many following requests into multi-row
+ * writes. They may not be written until bulk mode is turned off.
+ * IN: void * pointer returned from acct_storage_g_get_connection()
+ * IN: bool - true to start grouping, false to write what is pending and stop
+ * RET: SLURM_SUCCESS on success SLURM_ERROR if any grouped write failed
+ */
+extern int acct_storage_g_bulk_write(void *db_conn, bool enable);
+
 /*
  * add users to accounting system
  * IN:  user_list List of slurmdb_user_rec_t *
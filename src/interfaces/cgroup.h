@@ -156,6 +156,12 @@ typedef struct {
 	uint64_t total_rss;
 	uint64_t total_pgmajfault;
 	uint64_t total_vmem;
+	uint64_t total_io_read;		/* bytes read, NO_VAL64 if unknown */
+	uint64_t total_io_write;	/* bytes written, NO_VAL64 if unknown */
+	/* PSI "some" stall totals in usec, NO_VAL64 if unknown */
+	uint64_t cpu_pressure;
+	uint64_t mem_pressure;
+	uint64_t io_pressure;
 } cgroup_acct_t;
 
 /* Slurm cgroup plugins configuration parameters */
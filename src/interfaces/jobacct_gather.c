@@ -852,6 +852,12 @@ extern jobacctinfo_t *jobacctinfo_create(jobacct_id_t *jobacct_id)
 	jobacct->sys_cpu_usec = 0;
 	jobacct->user_cpu_sec = 0;
 	jobacct->user_cpu_usec = 0;
+	jobacct->cpu_pressure = NO_VAL64;
+	jobacct->mem_pressure = NO_VAL64;
+	jobacct->io_pressure = NO_VAL64;
+	jobacct->last_cpu_pressure = NO_VAL64;
+	jobacct->last_mem_pressure = NO_VAL64;
+	jobacct->last_io_pressure = NO_VAL64;
 
 	_jobacctinfo_create_tres_usage(jobacct_id, jobacct);
 	return jobacct;
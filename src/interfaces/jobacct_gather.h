@@ -116,6 +116,14 @@ struct jobacctinfo {
 	double last_tres_usage_out_tot;
 	time_t cur_time;
 	time_t last_time;
+
+	/* PSI stall totals in usec, NO_VAL64 if unknown. Not packed. */
+	uint64_t cpu_pressure;
+	uint64_t mem_pressure;
+	uint64_t io_pressure;
+	uint64_t last_cpu_pressure;
+	uint64_t last_mem_pressure;
+	uint64_t last_io_pressure;
 };
 
 /* Define jobacctinfo_t below to avoid including extraneous slurm headers */
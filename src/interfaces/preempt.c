@@ -166,8 +166,13 @@ static int _add_preemptable_job(void *x, void *arg)
 	if (candidate->het_job_id && !candidate->het_job_list)
 		return 0;
 
-	if (_is_job_preempt_exempt(candidate, preemptor))
+	/*
+	 * Most of job_list is pending or finished, skip those before calling
+	 * into the plugin. job_overlap_and_running() rejects them anyway.
+	 */
+	if (!IS_JOB_RUNNING(candidate) && !IS_JOB_SUSPENDED(candidate))
 		return 0;
+
 	/*
 	 * We have to check the entire bitmap space here before we can check
 	 * each part of a hetjob in _is_job_preempt_exempt()
@@ -176,6 +181,9 @@ static int _add_preemptable_job(void *x, void *arg)
 				     preemptor->license_list, candidate))
 		return 0;
 
+	if (_is_job_preempt_exempt(candidate, preemptor))
+		return 0;
+
 	/* This job is a preemption candidate */
 	if (!candidates->preemptee_job_list)
 		candidates->preemptee_job_list = list_create(NULL);
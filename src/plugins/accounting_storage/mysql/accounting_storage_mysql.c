@@ -121,7 +121,18 @@ const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 static mysql_db_info_t *mysql_db_info = NULL;
 static char *mysql_db_name = NULL;
 
+/* Read replica set with READ_HOST in StorageParameters */
+static mysql_db_info_t *read_db_info = NULL;
+static list_t *read_conn_list = NULL; /* idle read replica connections */
+static pthread_mutex_t read_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t read_max_lag = 30; /* seconds the replica may lag behind */
+static time_t read_lag_time = 0; /* when the lag was last checked */
+static bool read_usable = false;
+static bool read_replica_status = false; /* SHOW REPLICA, not SHOW SLAVE */
+
 #define DELETE_SEC_BACK 86400
+#define READ_CONN_MAX_IDLE 16
+#define READ_LAG_CHECK_INTERVAL 10
 
 char *acct_coord_table = "acct_coord_table";
 char *acct_table = "acct_table";
@@ -164,6 +175,7 @@ char *step_view = "step_view";
 char *step_ext_view = "step_ext_view";
 
 bool backup_dbd = 0;
+bool job_partition = false;
 
 static char *default_qos_str = NULL;
 
@@ -1509,6 +1521,8 @@ extern int create_cluster_tables(mysql_conn_t *mysql_conn, char *cluster_name)
 	};
 
 	char table_name[200];
+	char *job_keys = NULL;
+	int rc;
 
 	if (create_cluster_assoc_table(mysql_conn, cluster_name)
 	    == SLURM_ERROR)
@@ -1588,12 +1602,21 @@ extern int create_cluster_tables(mysql_conn_t *mysql_conn, char *cluster_name)
 	snprintf(table_name, sizeof(table_name), "\"%s_%s\"",
 		 cluster_name, job_table);
 
+	/*
+	 * A partitioned table needs the partitioning column in its primary
+	 * key, so partitioning is removed before the primary key goes back to
+	 * job_db_inx alone and added after it includes time_submit.
+	 */
+	if (!job_partition &&
+	    (as_mysql_convert_job_partitions(mysql_conn, cluster_name) !=
+	     SLURM_SUCCESS))
+		return SLURM_ERROR;
+
 	/*
 	 * sacct_def is the index for query's with state as time_start is used
 	 * in these queries. sacct_def2 is for plain sacct queries.
 	 */
-	if (mysql_db_create_table(mysql_conn, table_name, job_table_fields,
-				  ", primary key (job_db_inx), "
+	job_keys = xstrdup_printf(", primary key (%s), "
 				  "unique index (id_job, time_submit), "
 				  "key old_tuple (id_job, "
 				  "id_assoc, time_submit), "
@@ -1612,8 +1635,18 @@ extern int create_cluster_tables(mysql_conn_t *mysql_conn, char *cluster_name)
 				  "time_eligible), "
 				  "key env_hash_inx (env_hash_inx), "
 				  "key script_hash_inx (script_hash_inx), "
-				  "key archive_purge (time_end))")
-	    == SLURM_ERROR)
+				  "key archive_purge (time_end))",
+				  job_partition ?
+				  "job_db_inx, time_submit" : "job_db_inx");
+	rc = mysql_db_create_table(mysql_conn, table_name, job_table_fields,
+				   job_keys);
+	xfree(job_keys);
+	if (rc == SLURM_ERROR)
+		return SLURM_ERROR;
+
+	if (job_partition &&
+	    (as_mysql_convert_job_partitions(mysql_conn, cluster_name) !=
+	     SLURM_SUCCESS))
 		return SLURM_ERROR;
 
 	snprintf(table_name, sizeof(table_name), "\"%s_%s\"",
@@ -2843,6 +2876,201 @@ static int _send_ctld_update(void *x, void *arg)
 	return 0;
 }
 
+static void _destroy_read_conn(void *x)
+{
+	destroy_mysql_conn(x);
+}
+
+static void _parse_storage_params(void)
+{
+	char *tmp_opts, *token, *save_ptr = NULL;
+	char *host = NULL;
+	uint32_t port = 0;
+
+	if (!mysql_db_info->params)
+		return;
+
+	tmp_opts = xstrdup(mysql_db_info->params);
+	token = strtok_r(tmp_opts, ",", &save_ptr);
+	while (token) {
+		char *opt_str, *val_str = NULL;
+
+		opt_str = strtok_r(token, "=", &val_str);
+		if (opt_str && val_str) {
+			if (!xstrcasecmp(opt_str, "READ_HOST"))
+				host = val_str;
+			else if (!xstrcasecmp(opt_str, "READ_PORT"))
+				port = atoi(val_str);
+			else if (!xstrcasecmp(opt_str, "READ_MAX_LAG"))
+				read_max_lag = atoi(val_str);
+			else if (!xstrcasecmp(opt_str, "JOB_PARTITION")) {
+				if (!xstrcasecmp(val_str, "month"))
+					job_partition = true;
+				else
+					error("Invalid JOB_PARTITION '%s', only 'month' is supported",
+					      val_str);
+			}
+		}
+		token = strtok_r(NULL, ",", &save_ptr);
+	}
+
+	if (host) {
+		read_db_info = xmalloc(sizeof(*read_db_info));
+		read_db_info->host = xstrdup(host);
+		read_db_info->port = port ? port : mysql_db_info->port;
+		read_db_info->user = xstrdup(mysql_db_info->user);
+		read_db_info->pass = xstrdup(mysql_db_info->pass);
+		read_db_info->params = xstrdup(mysql_db_info->params);
+		read_conn_list = list_create(_destroy_read_conn);
+		verbose("Sending queries to read replica %s:%u when less than %u seconds behind",
+			read_db_info->host, read_db_info->port, read_max_lag);
+	}
+
+	xfree(tmp_opts);
+}
+
+/*
+ * Ask the replica how far it is behind the primary. Replication stopped or a
+ * server that is not replicating count as too far.
+ * RET true if the replica is within read_max_lag
+ */
+static bool _read_replica_lag_ok(mysql_conn_t *read_conn)
+{
+	MYSQL_RES *result;
+	MYSQL_ROW row;
+	MYSQL_FIELD *fields;
+	int i, lag_field = -1;
+	bool ok = false;
+
+	if (!(result = mysql_db_query_ret(read_conn, read_replica_status ?
+					  "SHOW REPLICA STATUS" :
+					  "SHOW SLAVE STATUS", 0))) {
+		/* SHOW SLAVE STATUS is gone from newer MySQL */
+		read_replica_status = !read_replica_status;
+		return false;
+	}
+
+	fields = mysql_fetch_fields(result);
+	for (i = 0; i < mysql_num_fields(result); i++) {
+		if (!xstrcasecmp(fields[i].name, "Seconds_Behind_Master") ||
+		    !xstrcasecmp(fields[i].name, "Seconds_Behind_Source")) {
+			lag_field = i;
+			break;
+		}
+	}
+
+	if ((lag_field >= 0) && (row = mysql_fetch_row(result))) {
+		if (!row[lag_field])
+			debug("%s: replication on %s is not running",
+			      __func__, read_db_info->host);
+		else if (slurm_atoul(row[lag_field]) > read_max_lag)
+			debug("%s: %s is %s seconds behind",
+			      __func__, read_db_info->host, row[lag_field]);
+		else
+			ok = true;
+	} else {
+		debug("%s: %s is not a replica", __func__, read_db_info->host);
+	}
+	mysql_free_result(result);
+
+	return ok;
+}
+
+static void _read_conn_put(mysql_conn_t *mysql_conn, mysql_conn_t *read_conn)
+{
+	if (read_conn == mysql_conn)
+		return;
+
+	slurm_mutex_lock(&read_lock);
+	if (read_conn_list &&
+	    (list_count(read_conn_list) < READ_CONN_MAX_IDLE)) {
+		list_push(read_conn_list, read_conn);
+		read_conn = NULL;
+	}
+	slurm_mutex_unlock(&read_lock);
+
+	destroy_mysql_conn(read_conn);
+}
+
+/*
+ * Get a connection to run a query on. This is one to the read replica if one
+ * is configured and is recent enough, otherwise mysql_conn itself. Changes of
+ * mysql_conn not yet committed are only visible on the primary, so they keep
+ * the query there as well. DB_CONN_FLAG_REPLICA_READ of mysql_conn tells
+ * which one was picked.
+ * RET connection to pass to _read_conn_put() once done
+ */
+static mysql_conn_t *_read_conn_get(mysql_conn_t *mysql_conn)
+{
+	mysql_conn_t *read_conn;
+	bool check_lag = false;
+	time_t now = time(NULL);
+
+	if (mysql_conn)
+		mysql_conn->flags &= ~DB_CONN_FLAG_REPLICA_READ;
+
+	if (!read_db_info || !mysql_conn ||
+	    (mysql_conn->flags & DB_CONN_FLAG_DIRTY))
+		return mysql_conn;
+
+	slurm_mutex_lock(&read_lock);
+	if ((now - read_lag_time) >= READ_LAG_CHECK_INTERVAL) {
+		read_lag_time = now;
+		check_lag = true;
+	} else if (!read_usable) {
+		slurm_mutex_unlock(&read_lock);
+		return mysql_conn;
+	}
+	read_conn = list_pop(read_conn_list);
+	slurm_mutex_unlock(&read_lock);
+
+	if (read_conn && mysql_db_ping(read_conn)) {
+		destroy_mysql_conn(read_conn);
+		read_conn = NULL;
+	}
+
+	if (!read_conn) {
+		read_conn = create_mysql_conn(mysql_conn->conn, false,
+					      mysql_conn->cluster_name);
+		read_conn->flags |= DB_CONN_FLAG_READ_ONLY;
+		if (mysql_db_get_db_connection(read_conn, mysql_db_name,
+					       read_db_info)) {
+			destroy_mysql_conn(read_conn);
+			read_conn = NULL;
+			check_lag = false;
+			slurm_mutex_lock(&read_lock);
+			if (read_usable)
+				error("Read replica %s unreachable, using the primary database",
+				      read_db_info->host);
+			read_usable = false;
+			slurm_mutex_unlock(&read_lock);
+		}
+	}
+
+	if (check_lag) {
+		bool usable = _read_replica_lag_ok(read_conn);
+
+		slurm_mutex_lock(&read_lock);
+		if (usable != read_usable)
+			info("%s read replica %s",
+			     usable ? "Using" : "Not using",
+			     read_db_info->host);
+		read_usable = usable;
+		slurm_mutex_unlock(&read_lock);
+
+		if (!usable) {
+			_read_conn_put(mysql_conn, read_conn);
+			read_conn = NULL;
+		}
+	}
+
+	if (!read_conn)
+		return mysql_conn;
+
+	mysql_conn->flags |= DB_CONN_FLAG_REPLICA_READ;
+	return read_conn;
+}
+
 /*
  * init() is called when the plugin is loaded, before any other functions
  * are called.  Put global initialization here.
@@ -2867,6 +3095,7 @@ extern int init(void)
 
 	mysql_db_info = create_mysql_db_info(SLURM_MYSQL_PLUGIN_AS);
 	mysql_db_name = acct_get_db_name();
+	_parse_storage_params();
 
 	debug2("mysql_connect() called for db %s", mysql_db_name);
 	mysql_conn = create_mysql_conn(0, 1, NULL);
@@ -2911,6 +3140,11 @@ extern int fini ( void )
 	slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 	slurm_rwlock_destroy(&as_mysql_cluster_list_lock);
 	destroy_mysql_db_info(mysql_db_info);
+	slurm_mutex_lock(&read_lock);
+	FREE_NULL_LIST(read_conn_list);
+	destroy_mysql_db_info(read_db_info);
+	read_db_info = NULL;
+	slurm_mutex_unlock(&read_lock);
 	xfree(mysql_db_name);
 	xfree(default_qos_str);
 
@@ -3039,6 +3273,20 @@ extern int _add_feds_to_update_list(mysql_conn_t *mysql_conn, List update_list)
 	return rc;
 }
 
+extern int acct_storage_p_bulk_write(mysql_conn_t *mysql_conn, bool enable)
+{
+	if (!mysql_conn)
+		return ESLURM_DB_CONNECTION;
+
+	if (enable) {
+		mysql_conn->flags |= DB_CONN_FLAG_BULK;
+		return SLURM_SUCCESS;
+	}
+
+	mysql_conn->flags &= ~DB_CONN_FLAG_BULK;
+	return mysql_db_bulk_flush(mysql_conn);
+}
+
 extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 {
 	int rc = check_connection(mysql_conn);
@@ -3401,7 +3649,12 @@ extern List acct_storage_p_get_assocs(
 	mysql_conn_t *mysql_conn, uid_t uid,
 	slurmdb_assoc_cond_t *assoc_cond)
 {
-	return as_mysql_get_assocs(mysql_conn, uid, assoc_cond);
+	mysql_conn_t *read_conn = _read_conn_get(mysql_conn);
+	List ret_list = as_mysql_get_assocs(read_conn, uid, assoc_cond);
+
+	_read_conn_put(mysql_conn, read_conn);
+
+	return ret_list;
 }
 
 extern List acct_storage_p_get_events(mysql_conn_t *mysql_conn, uint32_t uid,
@@ -3492,7 +3745,12 @@ extern int acct_storage_p_get_usage(mysql_conn_t *mysql_conn, uid_t uid,
 				    void *in, slurmdbd_msg_type_t type,
 				    time_t start, time_t end)
 {
-	return as_mysql_get_usage(mysql_conn, uid, in, type, start, end);
+	mysql_conn_t *read_conn = _read_conn_get(mysql_conn);
+	int rc = as_mysql_get_usage(read_conn, uid, in, type, start, end);
+
+	_read_conn_put(mysql_conn, read_conn);
+
+	return rc;
 }
 
 extern int acct_storage_p_roll_usage(mysql_conn_t *mysql_conn,
@@ -3693,11 +3951,14 @@ extern List jobacct_storage_p_get_jobs_cond(mysql_conn_t *mysql_conn,
 					    slurmdb_job_cond_t *job_cond)
 {
 	List job_list = NULL;
+	mysql_conn_t *read_conn;
 
 	if (check_connection(mysql_conn) != SLURM_SUCCESS) {
 		return NULL;
 	}
-	job_list = as_mysql_jobacct_process_get_jobs(mysql_conn, uid, job_cond);
+	read_conn = _read_conn_get(mysql_conn);
+	job_list = as_mysql_jobacct_process_get_jobs(read_conn, uid, job_cond);
+	_read_conn_put(mysql_conn, read_conn);
 
 	return job_list;
 }
@@ -3773,6 +4034,17 @@ extern int acct_storage_p_clear_stats(void *db_conn, bool dbd)
 extern int acct_storage_p_get_data(void *db_conn, acct_storage_info_t dinfo,
 				   void *data)
 {
+	mysql_conn_t *mysql_conn = db_conn;
+
+	switch (dinfo) {
+	case ACCT_STORAGE_INFO_REPLICA_READ:
+		*(bool *) data = mysql_conn &&
+			(mysql_conn->flags & DB_CONN_FLAG_REPLICA_READ);
+		break;
+	default:
+		break;
+	}
+
 	return SLURM_SUCCESS;
 }
 
@@ -115,6 +115,7 @@ extern List as_mysql_total_cluster_list;
 extern pthread_rwlock_t as_mysql_cluster_list_lock;
 
 extern bool backup_dbd;
+extern bool job_partition; /* job tables partitioned by month */
 
 typedef enum {
 	QOS_LEVEL_NONE,
@@ -37,14 +37,17 @@
 \*****************************************************************************/
 
 #include <fcntl.h>
+#include <limits.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 #include "as_mysql_archive.h"
+#include "as_mysql_convert.h"
 #include "src/common/env.h"
 #include "src/common/slurm_time.h"
 #include "src/common/slurmdbd_defs.h"
+#include "src/common/timers.h"
 
 #define SLURM_22_05_PROTOCOL_VERSION ((38 << 8) | 0)
 #define SLURM_21_08_PROTOCOL_VERSION ((37 << 8) | 0)
@@ -5012,6 +5015,8 @@ static int _archive_purge_table(purge_type_t purge_type, uint32_t usage_info,
 	char    *query = NULL, *sql_table = NULL,
 		*col_name = NULL;
 	uint32_t tmp_archive_period;
+	uint64_t arch_cnt = 0, purge_cnt = 0;
+	DEF_TIMERS;
 
 	switch (purge_type) {
 	case PURGE_EVENT:
@@ -5124,6 +5129,17 @@ static int _archive_purge_table(purge_type_t purge_type, uint32_t usage_info,
 		return SLURM_ERROR;
 	}
 
+	START_TIMER;
+	/*
+	 * Without archiving, whole months of jobs go by dropping their
+	 * partition instead of deleting them row by row.
+	 */
+	if ((purge_type == PURGE_JOB) && job_partition &&
+	    !SLURMDB_PURGE_ARCHIVE_SET(purge_attr) &&
+	    (as_mysql_convert_job_partitions_purge(mysql_conn, cluster_name,
+						   curr_end) != SLURM_SUCCESS))
+		return SLURM_ERROR;
+
 	/* continue archive/purge until no records in the period are found */
 	while (1) {
 		rc = _get_oldest_record(mysql_conn, cluster_name, sql_table,
@@ -5161,6 +5177,7 @@ static int _archive_purge_table(purge_type_t purge_type, uint32_t usage_info,
 				return SLURM_ERROR;
 			} else if (rc == SLURM_ERROR)
 				return rc;
+			arch_cnt += rc;
 
 			if (purge_type == PURGE_JOB) {
 				/* Archive associated data from hash tables */
@@ -5225,6 +5242,7 @@ static int _archive_purge_table(purge_type_t purge_type, uint32_t usage_info,
 		 */
 		if ((rc = mysql_db_delete_affected_rows(
 				mysql_conn, query)) > 0) {
+			purge_cnt += rc;
 			/* Commit here every time since this could create a huge
 			 * transaction.
 			 */
@@ -5244,6 +5262,19 @@ static int _archive_purge_table(purge_type_t purge_type, uint32_t usage_info,
 			break;
 		}
 	}
+	END_TIMER;
+
+	/* Archived jobs are deleted above, drop what is left of partitions */
+	if ((purge_type == PURGE_JOB) && job_partition &&
+	    SLURMDB_PURGE_ARCHIVE_SET(purge_attr) &&
+	    (as_mysql_convert_job_partitions_purge(mysql_conn, cluster_name,
+						   curr_end) != SLURM_SUCCESS))
+		return SLURM_ERROR;
+
+	if (purge_cnt)
+		debug("%s: archived %"PRIu64" and purged %"PRIu64" records from %s_%s in %s (%"PRIu64" records/sec)",
+		      __func__, arch_cnt, purge_cnt, cluster_name, sql_table,
+		      TIME_STR, (purge_cnt * USEC_IN_SEC) / MAX(DELTA_TIMER, 1));
 
 	return SLURM_SUCCESS;
 }
@@ -5417,6 +5448,7 @@ static int _process_archive_data(char **data_in, uint32_t data_size,
 	uint32_t rec_cnt = 0;
 	uint32_t rec_cnt_total = 0, rec_cnt_left = 0, pass_cnt = 0;
 	char *cluster_name = NULL;
+	DEF_TIMERS;
 
 	xassert(data_in);
 
@@ -5452,6 +5484,7 @@ static int _process_archive_data(char **data_in, uint32_t data_size,
 
 	rec_cnt_left = rec_cnt;
 	rec_cnt_total = rec_cnt;
+	START_TIMER;
 	while (rec_cnt_left) {
 		char *data = NULL;
 
@@ -5513,6 +5546,14 @@ static int _process_archive_data(char **data_in, uint32_t data_size,
 
 		pass_cnt++;
 	}
+	END_TIMER;
+
+	if (!error_code)
+		debug("%s: loaded %u %s records for cluster %s in %s (%"PRIu64" records/sec)",
+		      __func__, rec_cnt_total, slurmdbd_msg_type_2_str(type, 0),
+		      cluster_name, TIME_STR,
+		      ((uint64_t) rec_cnt_total * USEC_IN_SEC) /
+		      MAX(DELTA_TIMER, 1));
 
 cleanup:
 	FREE_NULL_BUFFER(buffer);
@@ -5544,15 +5585,30 @@ extern int as_mysql_jobacct_process_archive_load(
 		data = xstrdup(arch_rec->insert);
 	} else if (arch_rec->archive_file) {
 		int data_allocated, data_read = 0;
+		struct stat stat_buf;
 		int state_fd = open(arch_rec->archive_file, O_RDONLY);
 		if (state_fd < 0) {
 			info("Could not open archive file `%s`: %m",
 			     arch_rec->archive_file);
 			error_code = errno;
 		} else {
-			data_allocated = BUF_SIZE + 1;
+			/*
+			 * Size the buffer for the whole file up front, archives
+			 * can be large and growing it on every read means
+			 * copying them over and over.
+			 */
+			if (!fstat(state_fd, &stat_buf) &&
+			    (stat_buf.st_size > 0) &&
+			    (stat_buf.st_size < INT_MAX - BUF_SIZE))
+				data_allocated = stat_buf.st_size + BUF_SIZE + 1;
+			else
+				data_allocated = BUF_SIZE + 1;
 			data = xmalloc_nz(data_allocated);
 			while (1) {
+				if ((data_allocated - data_size) <= BUF_SIZE) {
+					data_allocated += BUF_SIZE;
+					xrealloc_nz(data, data_allocated);
+				}
 				data_read = read(state_fd, &data[data_size],
 						 BUF_SIZE);
 				if (data_read < 0) {
@@ -5568,9 +5624,7 @@ extern int as_mysql_jobacct_process_archive_load(
 				data[data_size + data_read] = '\0';
 				if (data_read == 0)	/* eof */
 					break;
-				data_size      += data_read;
-				data_allocated += data_read;
-				xrealloc_nz(data, data_allocated);
+				data_size += data_read;
 			}
 			close(state_fd);
 		}
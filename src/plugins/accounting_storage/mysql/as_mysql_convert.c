@@ -37,6 +37,7 @@
 
 #include "as_mysql_convert.h"
 #include "as_mysql_tres.h"
+#include "src/common/slurm_time.h"
 #include "src/interfaces/jobacct_gather.h"
 
 /*
@@ -440,6 +441,197 @@ extern int as_mysql_convert_non_cluster_tables_post_create(
 	return rc;
 }
 
+/* Start of the month offset months after the one t is in */
+static time_t _month_start(time_t t, int offset)
+{
+	struct tm tm;
+
+	localtime_r(&t, &tm);
+	tm.tm_sec = 0;
+	tm.tm_min = 0;
+	tm.tm_hour = 0;
+	tm.tm_mday = 1;
+	tm.tm_mon += offset;
+	tm.tm_isdst = -1;
+
+	return slurm_mktime(&tm);
+}
+
+/* Add a partition for the month starting at start to query */
+static time_t _add_month_partition(char **query, time_t start)
+{
+	time_t end = _month_start(start, 1);
+	struct tm tm;
+
+	localtime_r(&start, &tm);
+	xstrfmtcat(*query, "partition p%04d%02d values less than (%ld), ",
+		   tm.tm_year + 1900, tm.tm_mon + 1, end);
+
+	return end;
+}
+
+extern int as_mysql_convert_job_partitions(mysql_conn_t *mysql_conn,
+					   char *cluster_name)
+{
+	MYSQL_RES *result;
+	MYSQL_ROW row;
+	char *query;
+	time_t now = time(NULL), start = 0, want_end;
+	int parts = 0, rc = SLURM_SUCCESS;
+
+	if (backup_dbd)
+		return SLURM_SUCCESS;
+
+	query = xstrdup_printf("select partition_description from "
+			       "information_schema.partitions where "
+			       "table_schema=database() && "
+			       "table_name='%s_%s' && "
+			       "partition_name is not null "
+			       "order by partition_ordinal_position",
+			       cluster_name, job_table);
+	DB_DEBUG(DB_QUERY, mysql_conn->conn, "query\n%s", query);
+	result = mysql_db_query_ret(mysql_conn, query, 0);
+	xfree(query);
+	if (!result)
+		return SLURM_ERROR;
+	while ((row = mysql_fetch_row(result))) {
+		parts++;
+		if (row[0] && xstrcasecmp(row[0], "MAXVALUE"))
+			start = slurm_atoul(row[0]);
+	}
+	mysql_free_result(result);
+
+	if (!job_partition) {
+		if (!parts)
+			return SLURM_SUCCESS;
+		info("Removing partitioning of %s_%s, this may take a while",
+		     cluster_name, job_table);
+		query = xstrdup_printf("alter table \"%s_%s\" "
+				       "remove partitioning",
+				       cluster_name, job_table);
+		DB_DEBUG(DB_QUERY, mysql_conn->conn, "query\n%s", query);
+		rc = mysql_db_query(mysql_conn, query);
+		xfree(query);
+		return rc;
+	}
+
+	/* Always have partitions up to the end of next month */
+	want_end = _month_start(now, 2);
+
+	if (!parts) {
+		query = xstrdup_printf("select min(time_submit) from \"%s_%s\" "
+				       "where time_submit != 0",
+				       cluster_name, job_table);
+		DB_DEBUG(DB_QUERY, mysql_conn->conn, "query\n%s", query);
+		result = mysql_db_query_ret(mysql_conn, query, 0);
+		xfree(query);
+		if (!result)
+			return SLURM_ERROR;
+		if ((row = mysql_fetch_row(result)) && row[0])
+			start = slurm_atoul(row[0]);
+		mysql_free_result(result);
+
+		start = _month_start(start ? start : now, 0);
+
+		info("Partitioning %s_%s by month of submission, this may take a while",
+		     cluster_name, job_table);
+		query = xstrdup_printf("alter table \"%s_%s\" partition by "
+				       "range (time_submit) (",
+				       cluster_name, job_table);
+	} else if (start < want_end) {
+		if (!start)
+			start = _month_start(now, 0);
+		query = xstrdup_printf("alter table \"%s_%s\" reorganize "
+				       "partition pmax into (",
+				       cluster_name, job_table);
+	} else {
+		return SLURM_SUCCESS;
+	}
+
+	while (start < want_end)
+		start = _add_month_partition(&query, start);
+	xstrcat(query, "partition pmax values less than maxvalue)");
+
+	DB_DEBUG(DB_QUERY, mysql_conn->conn, "query\n%s", query);
+	rc = mysql_db_query(mysql_conn, query);
+	xfree(query);
+
+	return rc;
+}
+
+extern int as_mysql_convert_job_partitions_purge(mysql_conn_t *mysql_conn,
+						 char *cluster_name,
+						 time_t purge_end)
+{
+	MYSQL_RES *result;
+	MYSQL_ROW row;
+	char *query;
+	List drop_list;
+	char *name;
+	int rc = SLURM_SUCCESS;
+
+	query = xstrdup_printf("select partition_name, partition_description "
+			       "from information_schema.partitions where "
+			       "table_schema=database() && "
+			       "table_name='%s_%s' && "
+			       "partition_name is not null "
+			       "order by partition_ordinal_position",
+			       cluster_name, job_table);
+	DB_DEBUG(DB_QUERY, mysql_conn->conn, "query\n%s", query);
+	result = mysql_db_query_ret(mysql_conn, query, 0);
+	xfree(query);
+	if (!result)
+		return SLURM_ERROR;
+
+	drop_list = list_create(xfree_ptr);
+	while ((row = mysql_fetch_row(result))) {
+		MYSQL_RES *result2;
+		bool purgeable;
+
+		/*
+		 * Jobs submitted after purge_end can not have ended before it.
+		 * Leave the last partition so the range has no gap.
+		 */
+		if (!row[1] || !xstrcasecmp(row[1], "MAXVALUE") ||
+		    (slurm_atoul(row[1]) > purge_end))
+			break;
+
+		query = xstrdup_printf("select job_db_inx from \"%s_%s\" "
+				       "partition (%s) where time_end = 0 || "
+				       "time_end > %ld limit 1",
+				       cluster_name, job_table, row[0],
+				       purge_end);
+		DB_DEBUG(DB_QUERY, mysql_conn->conn, "query\n%s", query);
+		result2 = mysql_db_query_ret(mysql_conn, query, 0);
+		xfree(query);
+		if (!result2) {
+			rc = SLURM_ERROR;
+			break;
+		}
+		purgeable = !mysql_num_rows(result2);
+		mysql_free_result(result2);
+		if (!purgeable)
+			break;
+		list_append(drop_list, xstrdup(row[0]));
+	}
+	mysql_free_result(result);
+
+	while ((rc == SLURM_SUCCESS) && (name = list_pop(drop_list))) {
+		log_flag(DB_ARCHIVE, "Dropping partition %s of %s_%s",
+			 name, cluster_name, job_table);
+		query = xstrdup_printf("alter table \"%s_%s\" "
+				       "drop partition %s",
+				       cluster_name, job_table, name);
+		DB_DEBUG(DB_ARCHIVE, mysql_conn->conn, "query\n%s", query);
+		rc = mysql_db_query(mysql_conn, query);
+		xfree(query);
+		xfree(name);
+	}
+	FREE_NULL_LIST(drop_list);
+
+	return rc;
+}
+
 /*
  * Only use this when running "ALTER TABLE" during an upgrade.  This is to get
  * around that mysql cannot rollback an "ALTER TABLE", but its possible that the
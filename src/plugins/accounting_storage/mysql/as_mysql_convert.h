@@ -55,6 +55,22 @@ extern int as_mysql_convert_tables_post_create(mysql_conn_t *mysql_conn);
 extern int as_mysql_convert_non_cluster_tables_post_create(
 	mysql_conn_t *mysql_conn);
 
+/*
+ * Partition the job table of a cluster by month of submission when
+ * JOB_PARTITION is in StorageParameters, and add partitions up to the end of
+ * next month. Without JOB_PARTITION partitioning is removed again.
+ */
+extern int as_mysql_convert_job_partitions(mysql_conn_t *mysql_conn,
+					   char *cluster_name);
+
+/*
+ * Drop the oldest partitions of the job table of a cluster while all of their
+ * jobs ended before purge_end.
+ */
+extern int as_mysql_convert_job_partitions_purge(mysql_conn_t *mysql_conn,
+						 char *cluster_name,
+						 time_t purge_end);
+
 /*
  * Only use this when running "ALTER TABLE" during an upgrade.  This is to get
  * around that mysql cannot rollback an "ALTER TABLE", but its possible that the
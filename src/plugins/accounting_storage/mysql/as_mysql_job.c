@@ -1259,7 +1259,7 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 	char *node_list = NULL;
 	char *node_inx = NULL;
 	time_t start_time, submit_time;
-	char *query = NULL;
+	char *query = NULL, *row = NULL, *suffix = NULL;
 
 	if (!step_ptr->job_ptr->db_index
 	    && ((!step_ptr->job_ptr->details
@@ -1372,9 +1372,10 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 		xstrcat(query, ", submit_line");
 	if (step_ptr->container)
 		xstrcat(query, ", container");
+	xstrcat(query, ") values ");
 
-	xstrfmtcat(query,
-		   ") values (%"PRIu64", %d, %u, %d, '%s', %d, '%s', %d, %d, "
+	xstrfmtcat(row,
+		   "(%"PRIu64", %d, %u, %d, '%s', %d, '%s', %d, %d, "
 		   "'%s', '%s', %d, %u, %u, %u",
 		   step_ptr->job_ptr->db_index,
 		   step_ptr->step_id.step_id,
@@ -1386,30 +1387,41 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 		   step_ptr->cpu_freq_gov);
 
 	if (step_ptr->submit_line)
-		xstrfmtcat(query, ", '%s'", step_ptr->submit_line);
+		xstrfmtcat(row, ", '%s'", step_ptr->submit_line);
 	if (step_ptr->container)
-		xstrfmtcat(query, ", '%s'", step_ptr->container);
-
-	xstrfmtcat(query,
-		   ") on duplicate key update "
-		   "nodes_alloc=%d, task_cnt=%d, time_end=0, state=%d, "
-		   "nodelist='%s', node_inx='%s', task_dist=%d, "
-		   "req_cpufreq=%u, req_cpufreq_min=%u, req_cpufreq_gov=%u,"
-		   "tres_alloc='%s'",
-		   nodes, tasks, JOB_RUNNING,
-		   node_list, node_inx, task_dist, step_ptr->cpu_freq_max,
-		   step_ptr->cpu_freq_min, step_ptr->cpu_freq_gov,
-		   step_ptr->tres_alloc_str);
+		xstrfmtcat(row, ", '%s'", step_ptr->container);
+	xstrcat(row, ")");
+
+	/* Only refer to the new row so the same suffix serves every row */
+	xstrcat(suffix,
+		" on duplicate key update "
+		"nodes_alloc=VALUES(nodes_alloc), task_cnt=VALUES(task_cnt), "
+		"time_end=0, state=VALUES(state), "
+		"nodelist=VALUES(nodelist), node_inx=VALUES(node_inx), "
+		"task_dist=VALUES(task_dist), "
+		"req_cpufreq=VALUES(req_cpufreq), "
+		"req_cpufreq_min=VALUES(req_cpufreq_min), "
+		"req_cpufreq_gov=VALUES(req_cpufreq_gov), "
+		"tres_alloc=VALUES(tres_alloc)");
 
 	if (step_ptr->submit_line)
-		xstrfmtcat(query, ", submit_line='%s'", step_ptr->submit_line);
+		xstrcat(suffix, ", submit_line=VALUES(submit_line)");
 
 	if (step_ptr->container)
-		xstrfmtcat(query, ", container='%s'", step_ptr->container);
+		xstrcat(suffix, ", container=VALUES(container)");
 
-	DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
+	if (mysql_conn->flags & DB_CONN_FLAG_BULK) {
+		DB_DEBUG(DB_STEP, mysql_conn->conn, "bulk row\n%s%s%s",
+			 query, row, suffix);
+		mysql_db_bulk_add(mysql_conn, query, row, suffix);
+	} else {
+		xstrfmtcat(query, "%s%s", row, suffix);
+		DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s", query);
+		rc = mysql_db_query(mysql_conn, query);
+	}
 	xfree(query);
+	xfree(row);
+	xfree(suffix);
 
 	return rc;
 }
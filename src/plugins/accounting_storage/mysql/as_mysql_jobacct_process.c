@@ -470,6 +470,12 @@ static void _destroy_local_cluster(void *object)
 	}
 }
 
+/*
+ * Rows fetched at a time when the jobs are paged. Should be well above the
+ * number of records a single job id has in the job table.
+ */
+#define JOB_PAGE_MIN_ROWS 1000
+
 static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 			     slurmdb_user_rec_t *user,
 			     slurmdb_job_cond_t *job_cond,
@@ -496,6 +502,11 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	int comb_id = 0;
 	local_cluster_t *curr_cluster = NULL;
 	bool jobid_filtered = false;
+	char *page_query = NULL;
+	bool page_where = false, page_more = false;
+	uint32_t page_after = 0, page_next = 0, page_rows = 0;
+	uint32_t sent_cnt = list_count(sent_list);
+	int page_hold_id = -1;
 
 	/* This is here to make sure we are looking at only this user
 	 * if this flag is set.  We also include any accounts they may be
@@ -568,15 +579,36 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	if (extra) {
 		xstrcat(query, extra);
 		xfree(extra);
+		page_where = true;
 	}
 	if (job_cond->step_list)
 		jobid_filtered = true;
 
+	/*
+	 * When paging, fetch the jobs in chunks of id_job order starting
+	 * after the last job of the previous page.
+	 */
+	if (job_cond->page_size) {
+		if (!xstrcmp(job_cond->page_cluster, cluster_name))
+			page_after = job_cond->page_job_id;
+		page_rows = MAX(job_cond->page_size, JOB_PAGE_MIN_ROWS);
+		page_query = query;
+		query = NULL;
+	}
+
+next_chunk:
+	if (page_query)
+		query = xstrdup_printf("%s %s t1.id_job > %u",
+				       page_query, page_where ? "&&" : "where",
+				       page_after);
+
 	/* Here we want to order them this way in such a way so it is
 	   easy to look for duplicates, it is also easy to sort the
 	   resized jobs.
 	*/
 	xstrcat(query, " order by id_job, time_submit desc");
+	if (page_query)
+		xstrfmtcat(query, " limit %u", page_rows);
 
 	DB_DEBUG(DB_JOB, mysql_conn->conn, "query\n%s", query);
 	if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
@@ -586,6 +618,24 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	}
 	xfree(query);
 
+	if (page_query && (mysql_num_rows(result) == page_rows)) {
+		uint32_t first_id;
+
+		/*
+		 * There may be more rows. Leave the last job of this chunk for
+		 * the next one as its rows may continue there, unless it is
+		 * the only job in the chunk.
+		 */
+		page_more = true;
+		row = mysql_fetch_row(result);
+		first_id = slurm_atoul(row[JOB_REQ_JOBID]);
+		mysql_data_seek(result, page_rows - 1);
+		row = mysql_fetch_row(result);
+		page_next = slurm_atoul(row[JOB_REQ_JOBID]);
+		mysql_data_seek(result, 0);
+		if (first_id != page_next)
+			page_hold_id = page_next--;
+	}
 
 	/* Here we set up environment to check used nodes of jobs.
 	   Since we store the bitmap of the entire cluster we can use
@@ -593,7 +643,7 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	   things work.  This should go before the setup of conds
 	   since we could update the start/end time.
 	*/
-	if (job_cond && job_cond->used_nodes) {
+	if (job_cond && job_cond->used_nodes && !local_cluster_list) {
 		local_cluster_list = setup_cluster_list_with_inx(
 			mysql_conn, job_cond, (void **)&curr_cluster);
 		if (!local_cluster_list) {
@@ -611,6 +661,15 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 		int hetjob = slurm_atoul(row[JOB_REQ_HET_JOB_ID]);
 
 		curr_id = slurm_atoul(row[JOB_REQ_JOBID]);
+		if (curr_id == page_hold_id)
+			break;
+		/* Only end a page between jobs */
+		if (job_cond->page_size && (curr_id != last_id) &&
+		    ((sent_cnt + list_count(job_list)) >=
+		     job_cond->page_size)) {
+			page_more = false;
+			break;
+		}
 		if (job_cond && !(job_cond->flags & JOBCOND_FLAG_DUP)) {
 			if ((curr_id == last_id) &&
 			    (slurm_atoul(row[JOB_REQ_STATE]) != JOB_RESIZING))
@@ -1133,7 +1192,15 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	}
 	mysql_free_result(result);
 
+	if (page_more && job_list) {
+		page_after = page_next;
+		page_more = false;
+		page_hold_id = -1;
+		goto next_chunk;
+	}
+
 end_it:
+	xfree(page_query);
 	if (itr2)
 		list_iterator_destroy(itr2);
 
@@ -1686,6 +1753,15 @@ extern int setup_job_cond_limits(slurmdb_job_cond_t *job_cond,
 				   "t1.time_eligible < %ld))",
 				   job_cond->usage_end);
 		}
+
+		/*
+		 * Jobs are eligible after they are submitted, so this only
+		 * lets partitions of later months be skipped.
+		 */
+		if (job_partition && job_cond->usage_end &&
+		    !(job_cond->step_list && list_count(job_cond->step_list)))
+			xstrfmtcat(*extra, " && t1.time_submit < %ld",
+				   job_cond->usage_end);
 	}
 
 	if (job_cond->wckey_list && list_count(job_cond->wckey_list)) {
@@ -1722,7 +1798,7 @@ extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 	int only_pending = 0;
 	List use_cluster_list = NULL;
 	char *cluster_name;
-	bool locked = false;
+	bool locked = false, page_skip = true;
 	assoc_mgr_lock_t locks = { NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
 				   READ_LOCK, NO_LOCK, NO_LOCK };
 
@@ -1809,6 +1885,17 @@ extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 	itr = list_iterator_create(use_cluster_list);
 	while ((cluster_name = list_next(itr))) {
 		int rc;
+
+		/* A later page starts at the cluster the last one ended on */
+		if (job_cond->page_cluster && page_skip) {
+			if (xstrcmp(cluster_name, job_cond->page_cluster))
+				continue;
+			page_skip = false;
+		}
+		if (job_cond->page_size &&
+		    (list_count(job_list) >= job_cond->page_size))
+			break;
+
 		_setup_job_cond_selected_steps(job_cond, cluster_name, &extra);
 		if ((rc = _cluster_get_jobs(mysql_conn, &user, job_cond,
 					    cluster_name, tmp, tmp2, extra,
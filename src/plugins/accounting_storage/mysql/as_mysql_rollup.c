@@ -42,6 +42,7 @@
 #include "as_mysql_archive.h"
 #include "src/common/parse_time.h"
 #include "src/common/slurm_time.h"
+#include "src/common/xhash.h"
 
 enum {
 	TIME_ALLOC,
@@ -139,14 +140,36 @@ static int _find_loc_tres(void *x, void *key)
 	return 0;
 }
 
-static int _find_id_usage(void *x, void *key)
+static void _id_usage_hash_id(void *item, const char **key,
+			      uint32_t *key_len)
 {
-	local_id_usage_t *loc = (local_id_usage_t *)x;
-	uint32_t id = *(uint32_t *)key;
+	local_id_usage_t *usage = item;
 
-	if (loc->id == id)
-		return 1;
-	return 0;
+	*key = (const char *) &usage->id;
+	*key_len = sizeof(usage->id);
+}
+
+/*
+ * Find the usage record of an association or wckey, adding it to usage_list
+ * and usage_hash if not already there. Jobs come in no particular order so
+ * this is looked up once per job.
+ */
+static local_id_usage_t *_get_id_usage(List usage_list, xhash_t *usage_hash,
+				       int id, bool create_tres)
+{
+	local_id_usage_t *usage;
+
+	if (!(usage = xhash_get(usage_hash, (const char *) &id, sizeof(id)))) {
+		usage = xmalloc(sizeof(local_id_usage_t));
+		usage->id = id;
+		list_append(usage_list, usage);
+		xhash_add(usage_hash, usage);
+	}
+
+	if (create_tres && !usage->loc_tres)
+		usage->loc_tres = list_create(_destroy_local_tres_usage);
+
+	return usage;
 }
 
 static void _remove_job_tres_time_from_cluster(List c_tres, List j_tres,
@@ -1270,6 +1293,9 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 	List cluster_down_list = list_create(_destroy_local_cluster_usage);
 	List wckey_usage_list = list_create(_destroy_local_id_usage);
 	List resv_usage_list = list_create(_destroy_local_resv_usage);
+	/* Index of assoc_usage_list and wckey_usage_list, own nothing */
+	xhash_t *assoc_usage_hash = xhash_init(_id_usage_hash_id, NULL);
+	xhash_t *wckey_usage_hash = xhash_init(_id_usage_hash_id, NULL);
 	uint16_t track_wckey = slurm_get_track_wckey();
 	local_cluster_usage_t *loc_c_usage = NULL;
 	local_cluster_usage_t *c_usage = NULL;
@@ -1394,9 +1420,7 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 				       "job.time_eligible < %ld && "
 				       "(job.time_end >= %ld || "
 				       "job.time_end = 0)) "
-				       "group by job.job_db_inx "
-				       "order by job.id_assoc, "
-				       "job.time_eligible",
+				       "group by job.job_db_inx",
 				       job_str, cluster_name, job_table,
 				       curr_end, curr_start);
 
@@ -1485,13 +1509,13 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			}
 
 			if (last_id != assoc_id) {
-				a_usage = xmalloc(sizeof(local_id_usage_t));
-				a_usage->id = assoc_id;
-				list_append(assoc_usage_list, a_usage);
-				last_id = assoc_id;
 				/* a_usage->loc_tres is made later,
 				   don't do it here.
 				*/
+				a_usage = _get_id_usage(assoc_usage_list,
+							assoc_usage_hash,
+							assoc_id, false);
+				last_id = assoc_id;
 			}
 
 			/* Short circuit this so so we don't get a pointer. */
@@ -1500,20 +1524,9 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 
 			/* do the wckey calculation */
 			if (last_wckeyid != wckey_id) {
-				list_iterator_reset(w_itr);
-				while ((w_usage = list_next(w_itr)))
-					if (w_usage->id == wckey_id)
-						break;
-
-				if (!w_usage) {
-					w_usage = xmalloc(
-						sizeof(local_id_usage_t));
-					w_usage->id = wckey_id;
-					list_append(wckey_usage_list,
-						    w_usage);
-					w_usage->loc_tres = list_create(
-						_destroy_local_tres_usage);
-				}
+				w_usage = _get_id_usage(wckey_usage_list,
+							wckey_usage_hash,
+							wckey_id, true);
 				last_wckeyid = wckey_id;
 			}
 
@@ -1722,19 +1735,11 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 					r_usage->local_assocs);
 				while ((assoc = list_next(tmp_itr))) {
 					uint32_t associd = slurm_atoul(assoc);
-					if ((last_id != associd) &&
-					    !(a_usage = list_find_first(
-						      assoc_usage_list,
-						      _find_id_usage,
-						      &associd))) {
-						a_usage = xmalloc(
-							sizeof(local_id_usage_t));
-						a_usage->id = associd;
-						list_append(assoc_usage_list,
-							    a_usage);
-						a_usage->loc_tres = list_create(
-							_destroy_local_tres_usage);
-					}
+					if (last_id != associd)
+						a_usage = _get_id_usage(
+							assoc_usage_list,
+							assoc_usage_hash,
+							associd, true);
 					last_id = associd;
 
 					_add_time_tres(a_usage->loc_tres,
@@ -1824,6 +1829,8 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 		a_usage     = NULL;
 		w_usage     = NULL;
 
+		xhash_clear(assoc_usage_hash);
+		xhash_clear(wckey_usage_hash);
 		list_flush(assoc_usage_list);
 		list_flush(cluster_down_list);
 		list_flush(wckey_usage_list);
@@ -1846,6 +1853,8 @@ end_it:
 	if (r_itr)
 		list_iterator_destroy(r_itr);
 
+	xhash_free(assoc_usage_hash);
+	xhash_free(wckey_usage_hash);
 	FREE_NULL_LIST(assoc_usage_list);
 	FREE_NULL_LIST(cluster_down_list);
 	FREE_NULL_LIST(wckey_usage_list);
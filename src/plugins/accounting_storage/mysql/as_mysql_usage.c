@@ -37,6 +37,7 @@
 \*****************************************************************************/
 
 #include "as_mysql_cluster.h"
+#include "as_mysql_convert.h"
 #include "as_mysql_usage.h"
 #include "as_mysql_rollup.h"
 #include "src/common/macros.h"
@@ -912,7 +913,14 @@ extern int as_mysql_roll_usage(mysql_conn_t *mysql_conn, time_t sent_start,
 	slurm_rwlock_rdlock(&as_mysql_cluster_list_lock);
 	itr = list_iterator_create(as_mysql_cluster_list);
 	while ((cluster_name = list_next(itr))) {
-		local_rollup_t *local_rollup = xmalloc(sizeof(local_rollup_t));
+		local_rollup_t *local_rollup;
+
+		/* Keep partitions ready for jobs of the coming month */
+		if (job_partition)
+			(void) as_mysql_convert_job_partitions(mysql_conn,
+							       cluster_name);
+
+		local_rollup = xmalloc(sizeof(local_rollup_t));
 		local_rollup->archive_data = archive_data;
 		local_rollup->cluster_name = cluster_name;
 
@@ -680,6 +680,11 @@ extern int acct_storage_p_close_connection(void **db_conn)
 	return SLURM_SUCCESS;
 }
 
+extern int acct_storage_p_bulk_write(void *db_conn, bool enable)
+{
+	return SLURM_SUCCESS;
+}
+
 extern int acct_storage_p_commit(void *db_conn, bool commit)
 {
 	persist_msg_t req = {0};
@@ -3313,8 +3318,7 @@ extern int jobacct_storage_p_suspend(void *db_conn, job_record_t *job_ptr)
  * returns List of job_rec_t *
  * note List needs to be freed when called
  */
-extern List jobacct_storage_p_get_jobs_cond(void *db_conn, uid_t uid,
-					    slurmdb_job_cond_t *job_cond)
+static List _get_jobs_cond(void *db_conn, slurmdb_job_cond_t *job_cond)
 {
 	persist_msg_t req = {0}, resp = {0};
 	dbd_cond_msg_t get_msg;
@@ -3360,6 +3364,73 @@ extern List jobacct_storage_p_get_jobs_cond(void *db_conn, uid_t uid,
 	return my_job_list;
 }
 
+static int _set_last_job(void *x, void *arg)
+{
+	slurmdb_job_rec_t **last_job = arg;
+
+	*last_job = x;
+
+	return 0;
+}
+
+extern List jobacct_storage_p_get_jobs_cond(void *db_conn, uid_t uid,
+					    slurmdb_job_cond_t *job_cond)
+{
+	List job_list, page_list;
+	slurmdb_job_rec_t *last_job = NULL;
+	slurm_persist_conn_t *pc = db_conn ? db_conn : slurmdbd_conn;
+
+	if (!(job_list = _get_jobs_cond(db_conn, job_cond)) ||
+	    !job_cond || !job_cond->page_size)
+		return job_list;
+
+	/* Older slurmdbds ignore the paging fields and send every job */
+	if (!pc || (pc->version < SLURM_24_08_PROTOCOL_VERSION))
+		goto end_it;
+
+	/*
+	 * Ask for the page after the last job received until the slurmdbd
+	 * sends back a short one.
+	 */
+	page_list = job_list;
+	while (page_list && (list_count(page_list) >= job_cond->page_size)) {
+		list_for_each(page_list, _set_last_job, &last_job);
+		if (job_cond->page_cluster &&
+		    !xstrcmp(job_cond->page_cluster, last_job->cluster) &&
+		    (last_job->jobid <= job_cond->page_job_id)) {
+			/* Same page sent again, do not repeat its jobs */
+			error("%s: DBD_GET_JOBS_COND paging did not advance past job %u on cluster %s",
+			      __func__, job_cond->page_job_id,
+			      job_cond->page_cluster);
+			FREE_NULL_LIST(page_list);
+			page_list = job_list;
+			break;
+		}
+		xfree(job_cond->page_cluster);
+		job_cond->page_cluster = xstrdup(last_job->cluster);
+		job_cond->page_job_id = last_job->jobid;
+
+		if (page_list != job_list) {
+			list_transfer(job_list, page_list);
+			FREE_NULL_LIST(page_list);
+		}
+		page_list = _get_jobs_cond(db_conn, job_cond);
+	}
+
+	if (!page_list) {
+		FREE_NULL_LIST(job_list);
+	} else if (page_list != job_list) {
+		list_transfer(job_list, page_list);
+		FREE_NULL_LIST(page_list);
+	}
+
+end_it:
+	xfree(job_cond->page_cluster);
+	job_cond->page_job_id = 0;
+
+	return job_list;
+}
+
 /*
  * Expire old info from the storage
  * Not applicable for any database
@@ -3553,6 +3624,9 @@ extern int acct_storage_p_get_data(void *db_conn, acct_storage_info_t dinfo,
 	case ACCT_STORAGE_INFO_AGENT_COUNT:
 		*int_data = slurmdbd_agent_queue_count();
 		break;
+	case ACCT_STORAGE_INFO_AGENT_STATS:
+		slurmdbd_agent_get_stats(data);
+		break;
 	default:
 		error("data request %d invalid", dinfo);
 		rc = SLURM_ERROR;
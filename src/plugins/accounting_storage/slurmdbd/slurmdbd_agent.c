@@ -41,8 +41,11 @@
 
 #include "src/common/fd.h"
 #include "src/common/slurmdbd_pack.h"
+#include "src/common/timers.h"
 #include "src/common/xstring.h"
 
+#include "src/interfaces/accounting_storage.h"
+
 #include "slurmdbd_agent.h"
 
 enum {
@@ -51,16 +54,32 @@ enum {
 };
 
 typedef struct {
+	int cnt;
 	uint32_t msg_size;
-	list_t *my_list;
 } foreach_get_my_list_t;
 
+typedef struct {
+	list_t *msgs;
+	int rc;
+} foreach_mult_rc_t;
+
+/* Queued messages sent to the SlurmDBD and waiting for its reply */
+typedef struct {
+	buf_t *buffer;		/* packed DBD_SEND_MULT_MSG, NULL if single */
+	int cnt;		/* messages sent */
+	list_t *msgs;		/* buf_t, removed once acknowledged */
+	struct timeval sent;
+} agent_batch_t;
+
 slurm_persist_conn_t *slurmdbd_conn = NULL;
 
 
 #define DBD_MAGIC		0xDEAD3219
 #define DEBUG_PRINT_MAX_MSG_TYPES 10
 #define MAX_DBD_DEFAULT_ACTION MAX_DBD_ACTION_DISCARD
+#define DBD_AGENT_BATCH_MSGS	1000	/* messages per DBD_SEND_MULT_MSG */
+#define DBD_AGENT_MAX_WINDOW	16	/* max batches awaiting a reply */
+#define DBD_AGENT_SESSION_BATCHES 100	/* batches per slurmdbd_lock hold */
 
 static pthread_mutex_t agent_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t  agent_cond = PTHREAD_COND_INITIALIZER;
@@ -77,6 +96,12 @@ static pthread_cond_t  slurmdbd_cond = PTHREAD_COND_INITIALIZER;
 
 static int max_dbd_msg_action = MAX_DBD_DEFAULT_ACTION;
 
+/* Batches sent before waiting for the oldest reply, dbd_agent_window= */
+static int agent_window = 1;
+/* Messages taken off agent_list and not yet acknowledged */
+static uint32_t inflight_msgs = 0;
+static acct_storage_agent_stats_t agent_stats;
+
 static int _unpack_return_code(uint16_t rpc_version, buf_t *buffer)
 {
 	uint16_t msg_type = -1;
@@ -162,14 +187,14 @@ static int _get_return_code(void)
 static int _get_return_codes(void *x, void *arg)
 {
 	buf_t *out_buf = x;
-	int *rc_ptr = arg;
+	foreach_mult_rc_t *args = arg;
 	buf_t *b;
 
-	if ((*rc_ptr = _unpack_return_code(slurmdbd_conn->version, out_buf)) !=
-	    SLURM_SUCCESS)
+	if ((args->rc = _unpack_return_code(slurmdbd_conn->version,
+					    out_buf)) != SLURM_SUCCESS)
 		return -1;
 
-	if ((b = list_dequeue(agent_list))) {
+	if ((b = list_dequeue(args->msgs))) {
 		FREE_NULL_BUFFER(b);
 	} else {
 		error("DBD_GOT_MULT_MSG unpack message error");
@@ -178,13 +203,18 @@ static int _get_return_codes(void *x, void *arg)
 	return 0;
 }
 
-static int _handle_mult_rc_ret(void)
+/* Read the reply to a DBD_SEND_MULT_MSG, free acknowledged msgs */
+static int _handle_mult_rc_ret(list_t *msgs)
 {
 	buf_t *buffer;
 	uint16_t msg_type;
 	persist_rc_msg_t *msg = NULL;
 	dbd_list_msg_t *list_msg = NULL;
 	int rc = SLURM_ERROR;
+	foreach_mult_rc_t args = {
+		.msgs = msgs,
+		.rc = SLURM_ERROR,
+	};
 
 	buffer = slurm_persist_recv_msg(slurmdbd_conn);
 	if (buffer == NULL)
@@ -201,12 +231,8 @@ static int _handle_mult_rc_ret(void)
 			break;
 		}
 
-		slurm_mutex_lock(&agent_lock);
-		if (agent_list) {
-			list_for_each(list_msg->my_list, _get_return_codes,
-				      &rc);
-		}
-		slurm_mutex_unlock(&agent_lock);
+		list_for_each(list_msg->my_list, _get_return_codes, &args);
+		rc = args.rc;
 		slurmdbd_free_list_msg(list_msg);
 		break;
 	case PERSIST_RC:
@@ -535,6 +561,7 @@ static void _max_dbd_msg_action(uint32_t *msg_cnt)
 		purged = list_delete_all(agent_list, _purge_agent_list_req,
 					 &purge_type);
 		*msg_cnt -= purged;
+		agent_stats.msgs_discarded += purged;
 		info("purge %d step records", purged);
 	}
 	if (*msg_cnt >= (slurm_conf.max_dbd_msgs - 1)) {
@@ -542,6 +569,7 @@ static void _max_dbd_msg_action(uint32_t *msg_cnt)
 		purged = list_delete_all(agent_list, _purge_agent_list_req,
 					 &purge_type);
 		*msg_cnt -= purged;
+		agent_stats.msgs_discarded += purged;
 		info("purge %d job start records", purged);
 	}
 }
@@ -600,34 +628,195 @@ static int _get_my_list(void *x, void *arg)
 	args->msg_size += size_buf(buffer);
 	if (args->msg_size > MAX_MSG_SIZE)
 		return -1;
-	list_enqueue(args->my_list, buffer);
+	args->cnt++;
 
 	return 0;
 }
 
+static void _free_batch(void *x)
+{
+	agent_batch_t *batch = x;
+
+	FREE_NULL_BUFFER(batch->buffer);
+	FREE_NULL_LIST(batch->msgs);
+	xfree(batch);
+}
+
+/*
+ * Take the next batch of messages off the head of agent_list. Up to
+ * DBD_AGENT_BATCH_MSGS messages are packed into one DBD_SEND_MULT_MSG.
+ * IN partial - return a batch even if fewer than DBD_AGENT_BATCH_MSGS
+ *	messages are queued
+ * RET batch or NULL if nothing (or not enough) to send
+ */
+static agent_batch_t *_get_batch(bool partial)
+{
+	agent_batch_t *batch;
+	int cnt, max_msgs = DBD_AGENT_BATCH_MSGS;
+	foreach_get_my_list_t args = {
+		.msg_size = sizeof(persist_msg_t),
+	};
+
+	slurm_mutex_lock(&agent_lock);
+	if (!agent_list || !(cnt = list_count(agent_list)) ||
+	    (!partial && (cnt < DBD_AGENT_BATCH_MSGS))) {
+		slurm_mutex_unlock(&agent_lock);
+		return NULL;
+	}
+
+	if (cnt > 1)
+		list_for_each_max(agent_list, &max_msgs, _get_my_list, &args,
+				  1, true);
+
+	batch = xmalloc(sizeof(*batch));
+	batch->msgs = list_create(slurmdbd_free_buffer);
+	if (args.cnt > 1) {
+		dbd_list_msg_t list_msg = { 0 };
+		persist_msg_t list_req = {
+			.conn = slurmdbd_conn,
+			.data = &list_msg,
+			.msg_type = DBD_SEND_MULT_MSG,
+		};
+
+		list_transfer_max(batch->msgs, agent_list, args.cnt);
+		list_msg.my_list = batch->msgs;
+		batch->buffer = pack_slurmdbd_msg(&list_req,
+						  SLURM_PROTOCOL_VERSION);
+	} else
+		list_transfer_max(batch->msgs, agent_list, 1);
+	batch->cnt = list_count(batch->msgs);
+	inflight_msgs += batch->cnt;
+	slurm_mutex_unlock(&agent_lock);
+
+	return batch;
+}
+
+/* Read the reply for the oldest batch in flight */
+static int _recv_batch(agent_batch_t *batch)
+{
+	int rc;
+	uint32_t latency;
+
+	if (batch->buffer) {
+		rc = _handle_mult_rc_ret(batch->msgs);
+	} else {
+		rc = _get_return_code();
+		if (rc == SLURM_SUCCESS)
+			list_flush(batch->msgs);
+		else if ((rc == EAGAIN) && !*slurmdbd_conn->shutdown)
+			error("Failure with message need to resend: %d: %m",
+			      rc);
+	}
+
+	if (rc != SLURM_SUCCESS)
+		return rc;
+
+	latency = slurm_delta_tv(&batch->sent);
+	slurm_mutex_lock(&agent_lock);
+	agent_stats.batches++;
+	agent_stats.latency_last = latency;
+	agent_stats.latency_max = MAX(agent_stats.latency_max, latency);
+	agent_stats.latency_sum += latency;
+	slurm_mutex_unlock(&agent_lock);
+
+	return rc;
+}
+
+/* Move messages the SlurmDBD did not acknowledge to retry_list */
+static void _finish_batch(agent_batch_t *batch, list_t *retry_list)
+{
+	slurm_mutex_lock(&agent_lock);
+	inflight_msgs -= batch->cnt - list_count(batch->msgs);
+	slurm_mutex_unlock(&agent_lock);
+
+	list_transfer(retry_list, batch->msgs);
+	_free_batch(batch);
+}
+
+/*
+ * Send queued messages to the SlurmDBD with up to agent_window batches
+ * waiting for a reply at once. While a batch is in flight, the next one is
+ * only sent once DBD_AGENT_BATCH_MSGS messages are queued, so small batches
+ * wait at most one round trip to coalesce.
+ *
+ * Stops sending on error, shutdown or when slurmdbd_agent_send_recv() wants
+ * the connection, and reads all outstanding replies before returning.
+ * Unacknowledged messages go back to the head of agent_list in order.
+ *
+ * Call with slurmdbd_lock held and agent_lock not held.
+ * RET SLURM_SUCCESS or the first error seen
+ */
+static int _send_batches(void)
+{
+	list_t *inflight = list_create(_free_batch);
+	list_t *retry_list = list_create(slurmdbd_free_buffer);
+	agent_batch_t *batch;
+	int rc = SLURM_SUCCESS, batch_rc, sent = 0;
+	bool sending = true;
+
+	while (true) {
+		while (sending && (list_count(inflight) < agent_window) &&
+		       (sent < DBD_AGENT_SESSION_BATCHES) &&
+		       (batch = _get_batch(!list_count(inflight)))) {
+			buf_t *buffer = batch->buffer ? batch->buffer :
+				list_peek(batch->msgs);
+
+			gettimeofday(&batch->sent, NULL);
+			if ((batch_rc = slurm_persist_send_msg(slurmdbd_conn,
+							       buffer))) {
+				if (!*slurmdbd_conn->shutdown)
+					error("Failure sending message: %d: %m",
+					      batch_rc);
+				rc = batch_rc;
+				sending = false;
+				_finish_batch(batch, retry_list);
+				break;
+			}
+			list_enqueue(inflight, batch);
+			sent++;
+		}
+
+		if (!(batch = list_dequeue(inflight)))
+			break;
+		if ((batch_rc = _recv_batch(batch)) != SLURM_SUCCESS) {
+			if (rc == SLURM_SUCCESS)
+				rc = batch_rc;
+			sending = false;
+		}
+		_finish_batch(batch, retry_list);
+
+		if (halt_agent || *slurmdbd_conn->shutdown)
+			sending = false;
+	}
+	FREE_NULL_LIST(inflight);
+
+	slurm_mutex_lock(&agent_lock);
+	inflight_msgs -= list_count(retry_list);
+	if (agent_list) {
+		list_transfer(retry_list, agent_list);
+		list_transfer(agent_list, retry_list);
+	}
+	slurm_mutex_unlock(&agent_lock);
+	FREE_NULL_LIST(retry_list);
+
+	return rc;
+}
+
 static void *_agent(void *x)
 {
 	int rc;
 	uint32_t cnt;
-	buf_t *buffer;
 	struct timespec abs_time;
 	static time_t fail_time = 0;
-	persist_msg_t list_req = {0};
-	dbd_list_msg_t list_msg;
 	DEF_TIMERS;
 
 	slurm_mutex_lock(&agent_lock);
 	agent_running = true;
 	slurm_mutex_unlock(&agent_lock);
 
-	list_req.msg_type = DBD_SEND_MULT_MSG;
-	list_req.conn = slurmdbd_conn;
-	list_req.data = &list_msg;
-	memset(&list_msg, 0, sizeof(dbd_list_msg_t));
-
 	log_flag(DBD_AGENT, "slurmdbd agent_count=%d with msg_type=%s",
 		 list_count(agent_list),
-		 slurmdbd_msg_type_2_str(list_req.msg_type, 1));
+		 slurmdbd_msg_type_2_str(DBD_SEND_MULT_MSG, 1));
 
 	while (*slurmdbd_conn->shutdown == 0) {
 		slurm_mutex_lock(&slurmdbd_lock);
@@ -669,63 +858,18 @@ static void *_agent(void *x)
 		} else if (((cnt > 0) && ((cnt % 100) == 0)) ||
 		           (slurm_conf.debug_flags & DEBUG_FLAG_DBD_AGENT))
 			info("agent_count:%d", cnt);
-		/* Leave item on the queue until processing complete */
-		if (agent_list) {
-			if (cnt > 1) {
-				int max_rpcs = 1000;
-				foreach_get_my_list_t args = {
-					.msg_size = sizeof(list_req),
-					.my_list = list_create(NULL),
-				};
-
-				list_msg.my_list = args.my_list;
-
-				list_for_each_max(agent_list, &max_rpcs,
-						  _get_my_list, &args, 1, true);
-				buffer = pack_slurmdbd_msg(
-					&list_req, SLURM_PROTOCOL_VERSION);
-			} else
-				buffer = list_peek(agent_list);
-		} else
-			buffer = NULL;
 		slurm_mutex_unlock(&agent_lock);
-		if (buffer == NULL) {
-			slurm_mutex_unlock(&slurmdbd_lock);
-
-			slurm_mutex_lock(&assoc_cache_mutex);
-			if (slurmdbd_conn->fd >= 0 &&
-			    (running_cache != RUNNING_CACHE_STATE_NOTRUNNING))
-				slurm_cond_signal(&assoc_cache_cond);
-			slurm_mutex_unlock(&assoc_cache_mutex);
-
-			END_TIMER2("slurmdbd agent: empty buffer");
-			continue;
-		}
 
-		/* NOTE: agent_lock is clear here, so we can add more
-		 * requests to the queue while waiting for this RPC to
-		 * complete. */
-		rc = slurm_persist_send_msg(slurmdbd_conn, buffer);
-		if (rc != SLURM_SUCCESS) {
-			if (*slurmdbd_conn->shutdown) {
-				slurm_mutex_unlock(&slurmdbd_lock);
-				END_TIMER2("slurmdbd agent: shutdown");
-				break;
-			}
-			error("Failure sending message: %d: %m", rc);
-		} else if (list_msg.my_list) {
-			rc = _handle_mult_rc_ret();
-		} else {
-			rc = _get_return_code();
-			if (rc == EAGAIN) {
-				if (*slurmdbd_conn->shutdown) {
-					slurm_mutex_unlock(&slurmdbd_lock);
-					END_TIMER2("slurmdbd agent: EAGAIN on shutdown");
-					break;
-				}
-				error("Failure with "
-				      "message need to resend: %d: %m", rc);
-			}
+		/*
+		 * NOTE: agent_lock is clear here, so we can add more
+		 * requests to the queue while waiting for these RPCs to
+		 * complete.
+		 */
+		rc = _send_batches();
+		if ((rc != SLURM_SUCCESS) && *slurmdbd_conn->shutdown) {
+			slurm_mutex_unlock(&slurmdbd_lock);
+			END_TIMER2("slurmdbd agent: shutdown");
+			break;
 		}
 		slurm_mutex_unlock(&slurmdbd_lock);
 		slurm_mutex_lock(&assoc_cache_mutex);
@@ -735,30 +879,9 @@ static void *_agent(void *x)
 		slurm_mutex_unlock(&assoc_cache_mutex);
 
 		slurm_mutex_lock(&agent_lock);
-		if (agent_list && (rc == SLURM_SUCCESS)) {
-			/*
-			 * If we sent a mult_msg we just need to free buffer,
-			 * we don't need to requeue, just mark list_msg.my_list
-			 * as NULL as that is the sign we sent a mult_msg.
-			 */
-			if (list_msg.my_list) {
-				if (list_msg.my_list != agent_list)
-					FREE_NULL_LIST(list_msg.my_list);
-				list_msg.my_list = NULL;
-			} else
-				buffer = list_dequeue(agent_list);
-
-			FREE_NULL_BUFFER(buffer);
+		if (rc == SLURM_SUCCESS) {
 			fail_time = 0;
 		} else {
-			/* We need to free a mult_msg even on failure */
-			if (list_msg.my_list) {
-				if (list_msg.my_list != agent_list)
-					FREE_NULL_LIST(list_msg.my_list);
-				list_msg.my_list = NULL;
-				FREE_NULL_BUFFER(buffer);
-			}
-
 			fail_time = time(NULL);
 
 			if (slurm_conf.debug_flags & DEBUG_FLAG_DBD_AGENT) {
@@ -948,7 +1071,7 @@ extern int slurmdbd_agent_send(uint16_t rpc_version, persist_msg_t *req)
 			return SLURM_ERROR;
 		}
 	}
-	cnt = list_count(agent_list);
+	cnt = list_count(agent_list) + inflight_msgs;
 	if ((cnt >= (slurm_conf.max_dbd_msgs / 2)) &&
 	    (difftime(time(NULL), syslog_time) > 120)) {
 		/* Record critical error every 120 seconds */
@@ -964,6 +1087,7 @@ extern int slurmdbd_agent_send(uint16_t rpc_version, persist_msg_t *req)
 
 	if (cnt < slurm_conf.max_dbd_msgs) {
 		list_enqueue(agent_list, buffer);
+		agent_stats.queue_max = MAX(agent_stats.queue_max, cnt + 1);
 	} else {
 		error("agent queue is full (%u), discarding %s:%u request",
 		      cnt,
@@ -971,6 +1095,7 @@ extern int slurmdbd_agent_send(uint16_t rpc_version, persist_msg_t *req)
 		      req->msg_type);
 		(slurmdbd_conn->trigger_callbacks.acct_full)();
 		FREE_NULL_BUFFER(buffer);
+		agent_stats.msgs_discarded++;
 		rc = SLURM_ERROR;
 	}
 
@@ -990,7 +1115,14 @@ extern bool slurmdbd_conn_active(void)
 
 extern int slurmdbd_agent_queue_count(void)
 {
-	return list_count(agent_list);
+	return list_count(agent_list) + inflight_msgs;
+}
+
+extern void slurmdbd_agent_get_stats(acct_storage_agent_stats_t *stats)
+{
+	slurm_mutex_lock(&agent_lock);
+	*stats = agent_stats;
+	slurm_mutex_unlock(&agent_lock);
 }
 
 extern void slurmdbd_agent_config_setup(void)
@@ -1023,4 +1155,18 @@ extern void slurmdbd_agent_config_setup(void)
 		xfree(type);
 	} else
 		max_dbd_msg_action = MAX_DBD_DEFAULT_ACTION;
+
+	/*                          0123456789012345 */
+	if ((tmp_ptr = xstrcasestr(slurm_conf.slurmctld_params,
+				   "dbd_agent_window="))) {
+		int window = atoi(tmp_ptr + 17);
+
+		if ((window < 1) || (window > DBD_AGENT_MAX_WINDOW)) {
+			error("Invalid SlurmctldParameters dbd_agent_window=%d, must be between 1 and %d",
+			      window, DBD_AGENT_MAX_WINDOW);
+			window = MAX(1, MIN(window, DBD_AGENT_MAX_WINDOW));
+		}
+		agent_window = window;
+	} else
+		agent_window = 1;
 }
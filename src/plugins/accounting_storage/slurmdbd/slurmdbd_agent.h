@@ -42,6 +42,7 @@
 
 #include "dbd_conn.h"
 #include "src/common/assoc_mgr.h"
+#include "src/interfaces/accounting_storage.h"
 
 extern slurm_persist_conn_t *slurmdbd_conn;
 
@@ -74,6 +75,9 @@ extern bool slurmdbd_conn_active(void);
 /* Return the number of messages waiting to be sent to the DBD */
 extern int slurmdbd_agent_queue_count(void);
 
+/* Copy the agent's queue and commit latency statistics */
+extern void slurmdbd_agent_get_stats(acct_storage_agent_stats_t *stats);
+
 /* set up local variables based on slurm.conf params */
 extern void slurmdbd_agent_config_setup(void);
 
@@ -1453,6 +1453,11 @@ extern cgroup_acct_t *cgroup_p_task_get_acct_data(uint32_t taskid)
 	stats->total_rss = NO_VAL64;
 	stats->total_pgmajfault = NO_VAL64;
 	stats->total_vmem = NO_VAL64;
+	stats->total_io_read = NO_VAL64;
+	stats->total_io_write = NO_VAL64;
+	stats->cpu_pressure = NO_VAL64;
+	stats->mem_pressure = NO_VAL64;
+	stats->io_pressure = NO_VAL64;
 
 	if (common_cgroup_get_param(task_cpuacct_cg, "cpuacct.stat", &cpu_time,
 				    &cpu_time_sz) == SLURM_SUCCESS) {
@@ -2012,9 +2012,37 @@ extern int cgroup_p_task_addto(cgroup_ctl_type_t ctl, stepd_step_rec_t *step,
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Read the cumulative stall time from a PSI file (cpu.pressure,
+ * memory.pressure or io.pressure). The "some" line reads as:
+ * "some avg10=<f> avg60=<f> avg300=<f> total=<usec>"
+ *
+ * RET total usec some task of the cgroup was stalled, or NO_VAL64 if the
+ *     kernel doesn't provide PSI (CONFIG_PSI=n or psi=0).
+ */
+static uint64_t _get_pressure_total(xcgroup_t *cg, char *param)
+{
+	char *buf = NULL, *ptr;
+	size_t sz = 0;
+	uint64_t total = NO_VAL64;
+
+	if (common_cgroup_get_param(cg, param, &buf, &sz) != SLURM_SUCCESS)
+		return NO_VAL64;
+
+	if ((ptr = xstrstr(buf, "some")) && (ptr = xstrstr(ptr, "total=")) &&
+	    (sscanf(ptr, "total=%"PRIu64, &total) != 1)) {
+		log_flag(CGROUP, "Cannot parse total field in %s file", param);
+		total = NO_VAL64;
+	}
+	xfree(buf);
+
+	return total;
+}
+
 extern cgroup_acct_t *cgroup_p_task_get_acct_data(uint32_t task_id)
 {
 	char *cpu_stat = NULL, *memory_stat = NULL, *memory_current = NULL;
+	char *io_stat = NULL;
 	char *ptr;
 	size_t tmp_sz = 0;
 	cgroup_acct_t *stats = NULL;
@@ -2064,6 +2092,11 @@ extern cgroup_acct_t *cgroup_p_task_get_acct_data(uint32_t task_id)
 				 task_id);
 	}
 
+	/* io.stat only exists if the io controller is enabled */
+	if (common_cgroup_get_param(&task_cg_info->task_cg, "io.stat",
+				    &io_stat, &tmp_sz) != SLURM_SUCCESS)
+		log_flag(CGROUP, "Cannot read task %u io.stat file", task_id);
+
 	/*
 	 * Initialize values. A NO_VAL64 will indicate the caller that something
 	 * happened here. Values that aren't set here are returned as 0.
@@ -2073,6 +2106,14 @@ extern cgroup_acct_t *cgroup_p_task_get_acct_data(uint32_t task_id)
 	stats->ssec = NO_VAL64;
 	stats->total_rss = NO_VAL64;
 	stats->total_pgmajfault = NO_VAL64;
+	stats->total_io_read = NO_VAL64;
+	stats->total_io_write = NO_VAL64;
+	stats->cpu_pressure = _get_pressure_total(&task_cg_info->task_cg,
+						  "cpu.pressure");
+	stats->mem_pressure = _get_pressure_total(&task_cg_info->task_cg,
+						  "memory.pressure");
+	stats->io_pressure = _get_pressure_total(&task_cg_info->task_cg,
+						 "io.pressure");
 
 	if (cpu_stat) {
 		ptr = xstrstr(cpu_stat, "user_usec");
@@ -2109,6 +2150,29 @@ extern cgroup_acct_t *cgroup_p_task_get_acct_data(uint32_t task_id)
 		xfree(memory_stat);
 	}
 
+	/*
+	 * io.stat has one line per device in the form:
+	 * "<major>:<minor> rbytes=<n> wbytes=<n> rios=<n> wios=<n> ..."
+	 */
+	if (io_stat) {
+		char *save_ptr = NULL, *line;
+		uint64_t bytes;
+
+		stats->total_io_read = 0;
+		stats->total_io_write = 0;
+		line = strtok_r(io_stat, "\n", &save_ptr);
+		while (line) {
+			if ((ptr = xstrstr(line, "rbytes=")) &&
+			    (sscanf(ptr, "rbytes=%"PRIu64, &bytes) == 1))
+				stats->total_io_read += bytes;
+			if ((ptr = xstrstr(line, "wbytes=")) &&
+			    (sscanf(ptr, "wbytes=%"PRIu64, &bytes) == 1))
+				stats->total_io_write += bytes;
+			line = strtok_r(NULL, "\n", &save_ptr);
+		}
+		xfree(io_stat);
+	}
+
 	return stats;
 }
 
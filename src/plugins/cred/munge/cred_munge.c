@@ -53,6 +53,7 @@
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_protocol_pack.h"
 #include "src/common/xassert.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 #include "src/interfaces/cred.h"
@@ -61,6 +62,15 @@
 #define RETRY_COUNT		20
 #define RETRY_USEC		100000
 
+/*
+ * Network credentials carry the same node addresses for every message sent
+ * along a forwarding tree or for every repack of a step layout. Re-signing
+ * (and re-verifying) identical payloads costs a munged round-trip each time,
+ * so keep a small cache of recent signatures in both directions.
+ */
+#define SIG_CACHE_MAX		1024	/* max entries per cache */
+#define SIG_REUSE_MAX		10	/* max seconds to reuse a signature */
+
 #if defined (__APPLE__)
 extern slurm_conf_t slurm_conf __attribute__((weak_import));
 #else
@@ -106,12 +116,103 @@ enum local_error_code {
 	ESIG_CRED_REPLAYED,
 };
 
+typedef struct {
+	char *data;		/* signed payload */
+	uint32_t data_len;	/* size of signed payload */
+	time_t expiration;	/* time at which entry can no longer be used */
+	char *signature;	/* munge credential for payload */
+} sig_cache_ent_t;
+
+typedef struct {
+	xhash_idfunc_t idfunc;
+	time_t now;
+	xhash_t *table;
+} sig_cache_purge_args_t;
+
+static pthread_mutex_t sig_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static xhash_t *sign_cache = NULL;	/* keyed by payload */
+static xhash_t *verify_cache = NULL;	/* keyed by signature */
+
+static void _sig_cache_ent_free(void *x)
+{
+	sig_cache_ent_t *ent = x;
+
+	xfree(ent->data);
+	xfree(ent->signature);
+	xfree(ent);
+}
+
+static void _sign_cache_id(void *item, const char **key, uint32_t *key_len)
+{
+	sig_cache_ent_t *ent = item;
+
+	*key = ent->data;
+	*key_len = ent->data_len;
+}
+
+static void _verify_cache_id(void *item, const char **key, uint32_t *key_len)
+{
+	sig_cache_ent_t *ent = item;
+
+	*key = ent->signature;
+	*key_len = strlen(ent->signature);
+}
+
+static void _sig_cache_purge(void *item, void *arg)
+{
+	sig_cache_ent_t *ent = item;
+	sig_cache_purge_args_t *args = arg;
+	const char *key = NULL;
+	uint32_t key_len = 0;
+
+	if (ent->expiration > args->now)
+		return;
+
+	args->idfunc(ent, &key, &key_len);
+	xhash_delete(args->table, key, key_len);
+}
+
+/* Add entry to a cache, replacing any prior entry with the same key */
+static void _sig_cache_add(xhash_t *table, xhash_idfunc_t idfunc,
+			   sig_cache_ent_t *ent)
+{
+	const char *key = NULL;
+	uint32_t key_len = 0;
+	sig_cache_ent_t *old_ent;
+
+	idfunc(ent, &key, &key_len);
+	if ((old_ent = xhash_pop(table, key, key_len)))
+		_sig_cache_ent_free(old_ent);
+
+	if (xhash_count(table) >= SIG_CACHE_MAX) {
+		sig_cache_purge_args_t args = {
+			.idfunc = idfunc,
+			.now = time(NULL),
+			.table = table,
+		};
+
+		xhash_walk(table, _sig_cache_purge, &args);
+		if (xhash_count(table) >= SIG_CACHE_MAX)
+			xhash_clear(table);
+	}
+
+	xhash_add(table, ent);
+}
+
 /*
  * init() is called when the plugin is loaded, before any other functions
  * are called.  Put global initialization here.
  */
 extern int init(void)
 {
+	slurm_mutex_lock(&sig_cache_lock);
+	if (!sign_cache)
+		sign_cache = xhash_init(_sign_cache_id, _sig_cache_ent_free);
+	if (!verify_cache)
+		verify_cache = xhash_init(_verify_cache_id,
+					  _sig_cache_ent_free);
+	slurm_mutex_unlock(&sig_cache_lock);
+
 	verbose("%s loaded", plugin_name);
 	return SLURM_SUCCESS;
 }
@@ -122,6 +223,11 @@ extern int init(void)
  */
 extern int fini(void)
 {
+	slurm_mutex_lock(&sig_cache_lock);
+	xhash_free(sign_cache);
+	xhash_free(verify_cache);
+	slurm_mutex_unlock(&sig_cache_lock);
+
 	verbose("%s unloaded", plugin_name);
 	return SLURM_SUCCESS;
 }
@@ -198,6 +304,56 @@ again:
 	return signature;
 }
 
+/*
+ * Sign payload, reusing a recent signature of an identical payload if one is
+ * available. Only use for credentials that are verified with replay allowed.
+ */
+static char *_encode_cached(buf_t *buffer)
+{
+	static int reuse = -1;
+	sig_cache_ent_t *ent;
+	char *signature;
+	time_t now = time(NULL);
+
+	if (reuse < 0) {
+		int auth_ttl = slurm_get_auth_ttl();
+
+		reuse = SIG_REUSE_MAX;
+		if (auth_ttl && ((auth_ttl / 2) < reuse))
+			reuse = auth_ttl / 2;
+	}
+
+	slurm_mutex_lock(&sig_cache_lock);
+	if (sign_cache &&
+	    (ent = xhash_get(sign_cache, get_buf_data(buffer),
+			     get_buf_offset(buffer))) &&
+	    (ent->expiration > now)) {
+		signature = xstrdup(ent->signature);
+		slurm_mutex_unlock(&sig_cache_lock);
+		return signature;
+	}
+	slurm_mutex_unlock(&sig_cache_lock);
+
+	if (!(signature = _encode(buffer)) || !reuse)
+		return signature;
+
+	ent = xmalloc(sizeof(*ent));
+	ent->data_len = get_buf_offset(buffer);
+	ent->data = xmalloc(ent->data_len);
+	memcpy(ent->data, get_buf_data(buffer), ent->data_len);
+	ent->expiration = now + reuse;
+	ent->signature = xstrdup(signature);
+
+	slurm_mutex_lock(&sig_cache_lock);
+	if (sign_cache)
+		_sig_cache_add(sign_cache, _sign_cache_id, ent);
+	else
+		_sig_cache_ent_free(ent);
+	slurm_mutex_unlock(&sig_cache_lock);
+
+	return signature;
+}
+
 /*
  * WARNING: the buf_t returned from this is slightly non-standard.
  * The head points to malloc()'d memory, not xmalloc()'d, and needs
@@ -272,6 +428,53 @@ end_it:
 	return rc;
 }
 
+/*
+ * Same as _decode() with replay allowed, but a signature that has already
+ * been verified is served from the cache until its munge expiration.
+ *
+ * WARNING: the same non-standard buf_t handling as _decode() applies.
+ */
+static int _decode_cached(char *signature, buf_t **buffer, time_t *expiration)
+{
+	sig_cache_ent_t *ent;
+	time_t now = time(NULL);
+	int rc;
+
+	slurm_mutex_lock(&sig_cache_lock);
+	if (verify_cache && (ent = xhash_get_str(verify_cache, signature)) &&
+	    (ent->expiration > now)) {
+		char *data = malloc(ent->data_len);
+
+		if (data) {
+			memcpy(data, ent->data, ent->data_len);
+			*buffer = create_buf(data, ent->data_len);
+			*expiration = ent->expiration;
+			slurm_mutex_unlock(&sig_cache_lock);
+			return SLURM_SUCCESS;
+		}
+	}
+	slurm_mutex_unlock(&sig_cache_lock);
+
+	if ((rc = _decode(signature, true, buffer, expiration)))
+		return rc;
+
+	ent = xmalloc(sizeof(*ent));
+	ent->data_len = (*buffer)->size;
+	ent->data = xmalloc(ent->data_len);
+	memcpy(ent->data, (*buffer)->head, ent->data_len);
+	ent->expiration = *expiration;
+	ent->signature = xstrdup(signature);
+
+	slurm_mutex_lock(&sig_cache_lock);
+	if (verify_cache)
+		_sig_cache_add(verify_cache, _verify_cache_id, ent);
+	else
+		_sig_cache_ent_free(ent);
+	slurm_mutex_unlock(&sig_cache_lock);
+
+	return SLURM_SUCCESS;
+}
+
 static int _verify_signature(char *buffer, uint32_t buf_size, char *signature)
 {
 	int rc = SLURM_SUCCESS;
@@ -349,8 +552,8 @@ extern char *cred_p_create_net_cred(void *addrs, uint16_t protocol_version)
 
 	slurm_pack_node_alias_addrs(addrs, buffer, protocol_version);
 
-	if (!(signature = _encode(buffer)))
-		error("%s: _encode() failure", __func__);
+	if (!(signature = _encode_cached(buffer)))
+		error("%s: _encode_cached() failure", __func__);
 
 	free_buf(buffer);
 	return signature;
@@ -364,7 +567,7 @@ extern void *cred_p_extract_net_cred(char *net_cred, uint16_t protocol_version)
 	buf_t *buffer = NULL;
 
 	/* warning: do not use free_buf() on the returned buffer */
-	if ((rc = _decode(net_cred, true, &buffer, &expiration))) {
+	if ((rc = _decode_cached(net_cred, &buffer, &expiration))) {
 		error("%s: failed decode", __func__);
 		return NULL;
 	}
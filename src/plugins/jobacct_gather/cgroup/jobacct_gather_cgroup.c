@@ -83,6 +83,7 @@ const char plugin_type[] = "jobacct_gather/cgroup";
 const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 
 static bool is_first_task = true;
+static bool use_cgroup_stats = false;
 
 static void _prec_extra(jag_prec_t *prec, uint32_t taskid)
 {
@@ -139,10 +140,38 @@ static void _prec_extra(jag_prec_t *prec, uint32_t taskid)
 
 	}
 
+	/*
+	 * Without /proc scans the only source for disk usage is the cgroup.
+	 * Note that io.stat accounts for block device traffic, not for the
+	 * characters read/written reported by /proc/<pid>/io.
+	 */
+	if (use_cgroup_stats &&
+	    (cgroup_acct_data->total_io_read != NO_VAL64)) {
+		prec->tres_data[TRES_ARRAY_FS_DISK].size_read =
+			cgroup_acct_data->total_io_read;
+		prec->tres_data[TRES_ARRAY_FS_DISK].size_write =
+			cgroup_acct_data->total_io_write;
+	}
+
+	/*
+	 * Pressure stall information (cgroup/v2 only) tells how long the
+	 * tasks were waiting on cpu run queues, memory reclaim and io.
+	 */
+	prec->cpu_pressure = cgroup_acct_data->cpu_pressure;
+	prec->mem_pressure = cgroup_acct_data->mem_pressure;
+	prec->io_pressure = cgroup_acct_data->io_pressure;
+
 	xfree(cgroup_acct_data);
 	return;
 }
 
+/* The cgroup of the task already aggregates usage of all of its processes */
+static void _get_offspring_data(List prec_list, jag_prec_t *ancestor,
+				pid_t pid)
+{
+	return;
+}
+
 /*
  * init() is called when the plugin is loaded, before any other functions
  * are called.  Put global initialization here.
@@ -159,6 +188,12 @@ extern int init (void)
 	if (running_in_slurmstepd()) {
 		jag_common_init(cgroup_g_get_acct_units());
 
+		if (xstrcasestr(slurm_conf.job_acct_gather_params,
+				"UseCgroupStats")) {
+			use_cgroup_stats = true;
+			log_flag(JAG, "Not reading /proc, using cgroup statistics only as JobAcctGatherParams=UseCgroupStats is set.");
+		}
+
 		if (xcpuinfo_init() != SLURM_SUCCESS) {
 			return SLURM_ERROR;
 		}
@@ -223,6 +258,10 @@ extern void jobacct_gather_p_poll_data(List task_list, uint64_t cont_id,
 		memset(&callbacks, 0, sizeof(jag_callbacks_t));
 		first = 0;
 		callbacks.prec_extra = _prec_extra;
+		if (use_cgroup_stats) {
+			callbacks.get_precs = jag_common_get_task_precs;
+			callbacks.get_offspring_data = _get_offspring_data;
+		}
 	}
 
 	jag_common_poll_data(task_list, cont_id, &callbacks, profile);
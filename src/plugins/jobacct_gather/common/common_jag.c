@@ -494,6 +494,9 @@ static int _init_tres(jag_prec_t *prec, void *empty)
 		prec->tres_data[i].size_read = INFINITE64;
 		prec->tres_data[i].size_write = INFINITE64;
 	}
+	prec->cpu_pressure = NO_VAL64;
+	prec->mem_pressure = NO_VAL64;
+	prec->io_pressure = NO_VAL64;
 
 	return SLURM_SUCCESS;
 }
@@ -673,6 +676,51 @@ static List _get_precs(List task_list, uint64_t cont_id,
 	return prec_list;
 }
 
+extern List jag_common_get_task_precs(List task_list, uint64_t cont_id,
+				      jag_callbacks_t *callbacks)
+{
+	static int disable_gpu_acct = -1;
+	struct jobacctinfo *jobacct;
+	list_itr_t *itr;
+
+	xassert(task_list);
+
+	if (disable_gpu_acct == -1)
+		disable_gpu_acct = xstrcasestr(slurm_conf.job_acct_gather_params,
+					       "DisableGPUAcct") ? 1 : 0;
+
+	itr = list_iterator_create(task_list);
+	while ((jobacct = list_next(itr))) {
+		jag_prec_t *prec;
+
+		if (!(prec = list_find_first(prec_list, _find_prec,
+					     &jobacct->pid))) {
+			prec = xmalloc(sizeof(*prec));
+			prec->pid = jobacct->pid;
+			prec->tres_count = jobacct->tres_count;
+			prec->tres_data = xcalloc(prec->tres_count,
+						  sizeof(acct_gather_data_t));
+			(void) _init_tres(prec, NULL);
+			list_append(prec_list, prec);
+		}
+
+		if (!disable_gpu_acct)
+			gpu_g_usage_read(prec->pid, prec->tres_data);
+	}
+	list_iterator_destroy(itr);
+
+	return prec_list;
+}
+
+/* Convert a PSI stall delta in usec into a percentage of the interval */
+static double _pressure_pct(uint64_t cur, uint64_t last, double et)
+{
+	if (!et || (cur == NO_VAL64) || (last == NO_VAL64) || (cur < last))
+		return 0.0;
+
+	return (100.0 * (double)(cur - last)) / (et * USEC_IN_SEC);
+}
+
 static void _record_profile(struct jobacctinfo *jobacct)
 {
 	enum {
@@ -686,6 +734,9 @@ static void _record_profile(struct jobacctinfo *jobacct)
 		FIELD_PAGES,
 		FIELD_READ,
 		FIELD_WRITE,
+		FIELD_CPUPRESS,
+		FIELD_MEMPRESS,
+		FIELD_IOPRESS,
 		FIELD_CNT
 	};
 
@@ -700,6 +751,9 @@ static void _record_profile(struct jobacctinfo *jobacct)
 		{ "Pages", PROFILE_FIELD_UINT64 },
 		{ "ReadMB", PROFILE_FIELD_DOUBLE },
 		{ "WriteMB", PROFILE_FIELD_DOUBLE },
+		{ "CPUPressure", PROFILE_FIELD_DOUBLE },
+		{ "MemPressure", PROFILE_FIELD_DOUBLE },
+		{ "IOPressure", PROFILE_FIELD_DOUBLE },
 		{ NULL, PROFILE_FIELD_NOT_SET }
 	};
 
@@ -751,6 +805,9 @@ static void _record_profile(struct jobacctinfo *jobacct)
 		data[FIELD_GPUUTIL].d = 0.0;
 		data[FIELD_READ].d = 0.0;
 		data[FIELD_WRITE].d = 0.0;
+		data[FIELD_CPUPRESS].d = 0.0;
+		data[FIELD_MEMPRESS].d = 0.0;
+		data[FIELD_IOPRESS].d = 0.0;
 	} else {
 		data[FIELD_CPUTIME].d =
 			((double)jobacct->tres_usage_in_tot[TRES_ARRAY_CPU] -
@@ -789,6 +846,17 @@ static void _record_profile(struct jobacctinfo *jobacct)
 		data[FIELD_READ].d /= 1048576.0;
 		data[FIELD_WRITE].d /= 1048576.0;
 
+		/* Profile stalls as the % of the interval tasks were stalled */
+		data[FIELD_CPUPRESS].d = _pressure_pct(jobacct->cpu_pressure,
+						       jobacct->last_cpu_pressure,
+						       et);
+		data[FIELD_MEMPRESS].d = _pressure_pct(jobacct->mem_pressure,
+						       jobacct->last_mem_pressure,
+						       et);
+		data[FIELD_IOPRESS].d = _pressure_pct(jobacct->io_pressure,
+						      jobacct->last_io_pressure,
+						      et);
+
 		if (gpumem_pos != -1) {
 			/* Profile gpumem as MB */
 			data[FIELD_GPUMEM].u64 =
@@ -1176,6 +1244,10 @@ extern void jag_common_poll_data(List task_list, uint64_t cont_id,
 				prec->tres_data[i].size_write;
 		}
 
+		jobacct->cpu_pressure = prec->cpu_pressure;
+		jobacct->mem_pressure = prec->mem_pressure;
+		jobacct->io_pressure = prec->io_pressure;
+
 		total_job_mem += jobacct->tres_usage_in_tot[TRES_ARRAY_MEM];
 		total_job_vsize += jobacct->tres_usage_in_tot[TRES_ARRAY_VMEM];
 
@@ -1228,6 +1300,9 @@ extern void jag_common_poll_data(List task_list, uint64_t cont_id,
 				jobacct->tres_usage_out_tot[TRES_ARRAY_FS_DISK];
 			jobacct->last_total_cputime =
 				jobacct->tres_usage_in_tot[TRES_ARRAY_CPU];
+			jobacct->last_cpu_pressure = jobacct->cpu_pressure;
+			jobacct->last_mem_pressure = jobacct->mem_pressure;
+			jobacct->last_io_pressure = jobacct->io_pressure;
 
 			jobacct->last_time = jobacct->cur_time;
 		}
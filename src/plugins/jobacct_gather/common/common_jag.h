@@ -54,6 +54,10 @@ typedef struct jag_prec {	/* process record */
 	int     tres_count; /* count of tres in the tres_data */
 	acct_gather_data_t *tres_data; /* array of tres data */
 	double  usec; /* user cpu time: To normalize divide by system hertz */
+	/* PSI stall totals in usec, NO_VAL64 if unknown */
+	uint64_t cpu_pressure;
+	uint64_t mem_pressure;
+	uint64_t io_pressure;
 } jag_prec_t;
 
 typedef struct jag_callbacks {
@@ -71,4 +75,12 @@ extern void destroy_jag_prec(void *object);
 extern void jag_common_poll_data(List task_list, uint64_t cont_id,
 				 jag_callbacks_t *callbacks, bool profile);
 
+/*
+ * get_precs callback that builds a single prec per task without reading
+ * /proc for each process of the step. The usage of the task has to be
+ * filled in by the prec_extra callback.
+ */
+extern List jag_common_get_task_precs(List task_list, uint64_t cont_id,
+				      jag_callbacks_t *callbacks);
+
 #endif
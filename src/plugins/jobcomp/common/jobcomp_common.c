@@ -39,9 +39,24 @@
 #include "src/common/fd.h"
 #include "src/common/id_util.h"
 #include "src/common/parse_time.h"
+#include "src/interfaces/serializer.h"
 #include "src/plugins/jobcomp/common/jobcomp_common.h"
 #include "src/slurmctld/slurmctld.h"
 
+#define BATCH_MAX_RECORDS 1000000 /* records queued at most */
+#define BATCH_MAX_BYTES (512 * 1024 * 1024) /* payload bytes queued at most */
+#define BATCH_RETRY_MAX 30 /* seconds between retries at most */
+
+static pthread_mutex_t batch_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t batch_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t batch_thread = 0;
+static list_t *batch_list = NULL; /* jobcomp_common_record_t, oldest first */
+static uint64_t batch_bytes_queued = 0;
+static jobcomp_common_send_t batch_send = NULL;
+static uint32_t batch_max_records = 0;
+static uint32_t batch_max_bytes = 0;
+static bool batch_shutdown = false;
+
 /*
  * Open jobcomp state file, or backup if necessary.
  *
@@ -398,3 +413,179 @@ extern data_t *jobcomp_common_job_record_to_data(job_record_t *job_ptr) {
 
 	return record;
 }
+
+static void _destroy_record(void *x)
+{
+	jobcomp_common_record_t *record = x;
+
+	xfree(record->payload);
+	xfree(record);
+}
+
+static int _sum_record_size(void *x, void *arg)
+{
+	jobcomp_common_record_t *record = x;
+	uint32_t *bytes = arg;
+
+	*bytes += record->size;
+
+	return 0;
+}
+
+static void *_batch_handler(void *no_data)
+{
+	list_t *batch = list_create(_destroy_record);
+	jobcomp_common_record_t *record;
+	struct timespec ts = {0, 0};
+	uint32_t bytes, sent_cnt;
+	int retry = 0;
+
+	slurm_mutex_lock(&batch_lock);
+	while (!batch_shutdown) {
+		if (!list_count(batch_list)) {
+			slurm_cond_wait(&batch_cond, &batch_lock);
+			continue;
+		}
+
+		bytes = 0;
+		while ((list_count(batch) < batch_max_records) &&
+		       (record = list_peek(batch_list)) &&
+		       (!bytes ||
+			((bytes + record->size) <= batch_max_bytes))) {
+			bytes += record->size;
+			list_enqueue(batch, list_dequeue(batch_list));
+		}
+		batch_bytes_queued -= bytes;
+		slurm_mutex_unlock(&batch_lock);
+
+		sent_cnt = list_count(batch);
+		batch_send(batch);
+		sent_cnt -= list_count(batch);
+
+		slurm_mutex_lock(&batch_lock);
+		/* Put what was not sent back in front, in order */
+		bytes = 0;
+		(void) list_for_each(batch, _sum_record_size, &bytes);
+		batch_bytes_queued += bytes;
+		list_transfer(batch, batch_list);
+		list_transfer(batch_list, batch);
+
+		if (list_count(batch_list) && !sent_cnt) {
+			/* Nothing went through, back off before retrying */
+			retry = retry ? MIN(retry * 2, BATCH_RETRY_MAX) : 1;
+			log_flag(JOBCOMP, "%d records pending, retrying in %d seconds",
+				 list_count(batch_list), retry);
+			ts.tv_sec = time(NULL) + retry;
+			slurm_cond_timedwait(&batch_cond, &batch_lock, &ts);
+		} else {
+			retry = 0;
+		}
+	}
+	slurm_mutex_unlock(&batch_lock);
+
+	FREE_NULL_LIST(batch);
+
+	return NULL;
+}
+
+extern void jobcomp_common_batch_init(jobcomp_common_send_t send,
+				      uint32_t batch_records,
+				      uint32_t batch_bytes)
+{
+	slurm_mutex_lock(&batch_lock);
+	batch_send = send;
+	batch_max_records = batch_records;
+	batch_max_bytes = batch_bytes;
+	batch_shutdown = false;
+	if (!batch_list)
+		batch_list = list_create(_destroy_record);
+	slurm_mutex_unlock(&batch_lock);
+
+	slurm_thread_create(&batch_thread, _batch_handler, NULL);
+}
+
+extern int jobcomp_common_batch_add_payload(uint32_t job_id, char **payload)
+{
+	jobcomp_common_record_t *record;
+	uint32_t size = strlen(*payload);
+	int rc = SLURM_SUCCESS;
+
+	slurm_mutex_lock(&batch_lock);
+	if (!batch_list) {
+		rc = SLURM_ERROR;
+	} else if ((list_count(batch_list) >= BATCH_MAX_RECORDS) ||
+		   ((batch_bytes_queued + size) > BATCH_MAX_BYTES)) {
+		/* Never hold up the slurmctld, refuse new records instead */
+		rc = SLURM_ERROR;
+	} else {
+		record = xmalloc(sizeof(*record));
+		record->job_id = job_id;
+		record->payload = *payload;
+		record->size = size;
+		*payload = NULL;
+		list_enqueue(batch_list, record);
+		batch_bytes_queued += size;
+		slurm_cond_signal(&batch_cond);
+	}
+	slurm_mutex_unlock(&batch_lock);
+
+	return rc;
+}
+
+extern int jobcomp_common_batch_add(job_record_t *job_ptr)
+{
+	data_t *data;
+	char *payload = NULL;
+	int rc;
+
+	if (!(data = jobcomp_common_job_record_to_data(job_ptr))) {
+		error("%s: unable to build data_t. %pJ discarded",
+		      __func__, job_ptr);
+		return SLURM_ERROR;
+	}
+
+	if ((rc = serialize_g_data_to_string(&payload, NULL, data,
+					     MIME_TYPE_JSON,
+					     SER_FLAGS_COMPACT))) {
+		error("%s: %pJ discarded, unable to serialize to JSON: %s",
+		      __func__, job_ptr, slurm_strerror(rc));
+	} else if ((rc = jobcomp_common_batch_add_payload(job_ptr->job_id,
+							  &payload))) {
+		error("%s: Limit of %d records or %d bytes waiting to be sent reached. %pJ discarded",
+		      __func__, BATCH_MAX_RECORDS, BATCH_MAX_BYTES,
+		      job_ptr);
+	}
+
+	xfree(payload);
+	FREE_NULL_DATA(data);
+
+	return rc;
+}
+
+extern void jobcomp_common_batch_wake(void)
+{
+	slurm_mutex_lock(&batch_lock);
+	slurm_cond_signal(&batch_cond);
+	slurm_mutex_unlock(&batch_lock);
+}
+
+extern list_t *jobcomp_common_batch_fini(void)
+{
+	list_t *pending;
+
+	slurm_mutex_lock(&batch_lock);
+	batch_shutdown = true;
+	slurm_cond_broadcast(&batch_cond);
+	slurm_mutex_unlock(&batch_lock);
+
+	if (batch_thread)
+		slurm_thread_join(batch_thread);
+
+	slurm_mutex_lock(&batch_lock);
+	pending = batch_list;
+	batch_list = NULL;
+	batch_bytes_queued = 0;
+	slurm_mutex_unlock(&batch_lock);
+
+	return pending;
+}
@@ -43,4 +43,53 @@ extern buf_t *jobcomp_common_load_state_file(char *state_file);
 extern void jobcomp_common_write_state_file(buf_t *buffer, char *state_file);
 extern data_t *jobcomp_common_job_record_to_data(job_record_t *job_ptr);
 
+typedef struct {
+	uint32_t job_id; /* 0 if not known, e.g. loaded from old state */
+	char *payload; /* job record serialized to JSON */
+	uint32_t size; /* strlen(payload) */
+} jobcomp_common_record_t;
+
+/*
+ * Send a batch of records, from the batch thread.
+ * IN/OUT batch - list of jobcomp_common_record_t. Delete the records that were
+ *	sent, the ones left are sent again later.
+ */
+typedef void (*jobcomp_common_send_t)(list_t *batch);
+
+/*
+ * Start the thread handing queued records to send in batches.
+ * IN send - callback sending a batch
+ * IN batch_records - max records in a batch
+ * IN batch_bytes - max size of the payloads of a batch, one record at least
+ */
+extern void jobcomp_common_batch_init(jobcomp_common_send_t send,
+				      uint32_t batch_records,
+				      uint32_t batch_bytes);
+
+/*
+ * Serialize a job record to JSON and queue it.
+ * RET SLURM_SUCCESS or error if it can not be serialized or the queue is full
+ */
+extern int jobcomp_common_batch_add(job_record_t *job_ptr);
+
+/*
+ * Queue a serialized record, e.g. loaded from a state file.
+ * IN job_id - job the record is about, for logging
+ * IN/OUT payload - taken over and set to NULL
+ * RET SLURM_SUCCESS or SLURM_ERROR if the queue is full
+ */
+extern int jobcomp_common_batch_add_payload(uint32_t job_id, char **payload);
+
+/*
+ * Wake the batch thread up to send the queued records now, e.g. when the
+ * plugin can send again after being reconfigured.
+ */
+extern void jobcomp_common_batch_wake(void);
+
+/*
+ * Stop the batch thread.
+ * RET list of jobcomp_common_record_t not sent, caller must free it
+ */
+extern list_t *jobcomp_common_batch_fini(void);
+
 #endif
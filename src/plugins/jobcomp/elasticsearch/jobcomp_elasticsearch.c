@@ -65,7 +65,6 @@
 #include "src/slurmctld/state_save.h"
 
 #define MAX_STR_LEN 10240	/* 10 KB */
-#define MAX_JOBS 1000000
 
 /*
  * These variables are required by the generic plugin interface. If they
@@ -100,7 +99,9 @@ const char plugin_name[] = "Job completion elasticsearch logging plugin";
 const char plugin_type[] = "jobcomp/elasticsearch";
 const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 
-#define INDEX_RETRY_INTERVAL 30
+#define BATCH_MAX_RECORDS 1000 /* jobs sent in a _bulk request at most */
+#define BATCH_MAX_BYTES (5 * 1024 * 1024) /* size of a _bulk request at most */
+#define BULK_ACTION "{\"index\":{}}\n"
 
 /* These are defined here so when we link with something other than
  * the slurmctld we will have these symbols defined. They will get
@@ -120,21 +121,29 @@ struct http_response {
 	size_t size;
 };
 
-struct job_node {
-	time_t last_index_retry;
-	char * serialized_job;
-};
+typedef struct {
+	list_itr_t *iter;
+	int fail_cnt;
+	int success_cnt;
+} bulk_items_args_t;
 
 char *save_state_file = "elasticsearch_state";
 char *log_url = NULL;
+char *bulk_url = NULL; /* log_url with _doc replaced by _bulk, if possible */
 
-static pthread_cond_t location_cond = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t location_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t save_lock = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t pend_jobs_lock = PTHREAD_MUTEX_INITIALIZER;
-static pthread_t job_handler_thread;
-static List jobslist = NULL;
-static bool thread_shutdown = false;
+
+/* The state file only holds payloads, get the job id back for the logs */
+static uint32_t _payload_job_id(const char *payload)
+{
+	char *jobid = xstrstr(payload, "\"jobid\":");
+
+	if (!jobid)
+		return 0;
+
+	return strtoul(jobid + strlen("\"jobid\":"), NULL, 10);
+}
 
 /* Load jobcomp data from save state file */
 static int _load_pending_jobs(void)
@@ -143,7 +152,6 @@ static int _load_pending_jobs(void)
 	char *job_data = NULL;
 	uint32_t job_cnt = 0, tmp32 = 0;
 	buf_t *buffer = NULL;
-	struct job_node *jnode;
 
 	slurm_mutex_lock(&save_lock);
 	if (!(buffer = jobcomp_common_load_state_file(save_state_file))) {
@@ -155,9 +163,12 @@ static int _load_pending_jobs(void)
 	safe_unpack32(&job_cnt, buffer);
 	for (i = 0; i < job_cnt; i++) {
 		safe_unpackstr_xmalloc(&job_data, &tmp32, buffer);
-		jnode = xmalloc(sizeof(struct job_node));
-		jnode->serialized_job = job_data;
-		list_enqueue(jobslist, jnode);
+		if (jobcomp_common_batch_add_payload(_payload_job_id(job_data),
+						     &job_data)) {
+			error("%s: Unable to queue job loaded from state file, discarded",
+			      plugin_type);
+			xfree(job_data);
+		}
 	}
 	if (job_cnt > 0) {
 		log_flag(JOBCOMP, "Loaded %u jobs from state file", job_cnt);
@@ -188,22 +199,21 @@ static size_t _write_callback(void *contents, size_t size, size_t nmemb,
 	return realsize;
 }
 
-/* Try to index job into elasticsearch */
-static int _index_job(const char *jobcomp)
+/*
+ * POST body to url, location_mutex must be locked.
+ * OUT response - HTTP response body, caller must xfree()
+ * RET SLURM_SUCCESS on HTTP 200 (OK) or 201 (Created), SLURM_ERROR otherwise
+ */
+static int _post(const char *url, const char *content_type, const char *body,
+		 char **response)
 {
 	CURL *curl_handle = NULL;
 	CURLcode res;
 	struct http_response chunk;
 	struct curl_slist *slist = NULL;
+	char *header = NULL;
+	long code = 0;
 	int rc = SLURM_SUCCESS;
-	char *token = NULL;
-
-	slurm_mutex_lock(&location_mutex);
-	if (log_url == NULL) {
-		error("%s: JobCompLoc parameter not configured", plugin_type);
-		slurm_mutex_unlock(&location_mutex);
-		return SLURM_ERROR;
-	}
 
 	if (curl_global_init(CURL_GLOBAL_ALL) != 0) {
 		error("%s: curl_global_init: %m", plugin_type);
@@ -215,7 +225,9 @@ static int _index_job(const char *jobcomp)
 		goto cleanup_easy_init;
 	}
 
-	slist = curl_slist_append(slist, "Content-Type: " MIME_TYPE_JSON);
+	header = xstrdup_printf("Content-Type: %s", content_type);
+	slist = curl_slist_append(slist, header);
+	xfree(header);
 
 	if (slist == NULL) {
 		error("%s: curl_slist_append: %m", plugin_type);
@@ -226,13 +238,13 @@ static int _index_job(const char *jobcomp)
 	chunk.message = xmalloc(1);
 	chunk.size = 0;
 
-	if (curl_easy_setopt(curl_handle, CURLOPT_URL, log_url) ||
-	    curl_easy_setopt(curl_handle, CURLOPT_POST, 1) ||
-	    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, jobcomp) ||
+	if (curl_easy_setopt(curl_handle, CURLOPT_URL, url) ||
+	    curl_easy_setopt(curl_handle, CURLOPT_POST, 1L) ||
+	    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, body) ||
 	    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE,
-			     strlen(jobcomp)) ||
+			     strlen(body)) ||
 	    curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, slist) ||
-	    curl_easy_setopt(curl_handle, CURLOPT_HEADER, 1) ||
+	    curl_easy_setopt(curl_handle, CURLOPT_HEADER, 0L) ||
 	    curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION,
 			     _write_callback) ||
 	    curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, (void *) &chunk)) {
@@ -243,41 +255,31 @@ static int _index_job(const char *jobcomp)
 
 	if ((res = curl_easy_perform(curl_handle)) != CURLE_OK) {
 		log_flag(JOBCOMP, "Could not connect to: %s , reason: %s",
-			 log_url, curl_easy_strerror(res));
+			 url, curl_easy_strerror(res));
 		rc = SLURM_ERROR;
 		goto cleanup;
 	}
 
-	token = strtok(chunk.message, " ");
-	if (token == NULL) {
+	if (curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &code) !=
+	    CURLE_OK) {
 		error("%s: Could not receive the HTTP response status code from %s",
-		      plugin_type, log_url);
+		      plugin_type, url);
 		rc = SLURM_ERROR;
 		goto cleanup;
 	}
-	token = strtok(NULL, " ");
-
-	/* HTTP 100 (Continue). */
-	if ((xstrcmp(token, "100") == 0)) {
-		(void)  strtok(NULL, " ");
-		token = strtok(NULL, " ");
-	}
 
 	/*
 	 * HTTP 200 (OK)	- request succeed.
 	 * HTTP 201 (Created)	- request succeed and resource created.
 	 */
-	if ((xstrcmp(token, "200") != 0) && (xstrcmp(token, "201") != 0)) {
-		log_flag(JOBCOMP, "HTTP status code %s received from %s",
-			 token, log_url);
+	if ((code != 200) && (code != 201)) {
+		log_flag(JOBCOMP, "HTTP status code %ld received from %s",
+			 code, url);
 		log_flag(JOBCOMP, "HTTP response:\n%s", chunk.message);
 		rc = SLURM_ERROR;
 	} else {
-		token = strtok((char *)jobcomp, ",");
-		(void)  strtok(token, ":");
-		token = strtok(NULL, ":");
-		log_flag(JOBCOMP, "Job with jobid %s indexed into elasticsearch",
-			 token);
+		*response = chunk.message;
+		chunk.message = NULL;
 	}
 
 cleanup:
@@ -287,113 +289,153 @@ cleanup_easy_init:
 	curl_easy_cleanup(curl_handle);
 cleanup_global_init:
 	curl_global_cleanup();
-	slurm_mutex_unlock(&location_mutex);
 	return rc;
 }
 
-/* Saves the state of all jobcomp data for further indexing retries */
-static int _save_state(void)
+/* Try to index one job into elasticsearch, location_mutex must be locked */
+static int _index_job(jobcomp_common_record_t *record)
 {
-	int rc = SLURM_SUCCESS;
-	list_itr_t *iter;
-	static int high_buffer_size = (1024 * 1024);
-	buf_t *buffer = init_buf(high_buffer_size);
-	uint32_t job_cnt;
-	struct job_node *jnode;
+	char *response = NULL;
+	int rc;
 
-	job_cnt = list_count(jobslist);
-	pack32(job_cnt, buffer);
-	iter = list_iterator_create(jobslist);
-	while ((jnode = (struct job_node *)list_next(iter))) {
-		packstr(jnode->serialized_job, buffer);
-	}
-	list_iterator_destroy(iter);
+	if (!(rc = _post(log_url, MIME_TYPE_JSON, record->payload, &response)))
+		log_flag(JOBCOMP, "Job with jobid %u indexed into elasticsearch",
+			 record->job_id);
+	xfree(response);
 
-	slurm_mutex_lock(&save_lock);
-	jobcomp_common_write_state_file(buffer, save_state_file);
-	slurm_mutex_unlock(&save_lock);
+	return rc;
+}
 
-	FREE_NULL_BUFFER(buffer);
+static data_for_each_cmd_t _foreach_bulk_item(data_t *data, void *arg)
+{
+	bulk_items_args_t *args = arg;
+	jobcomp_common_record_t *record;
+	data_t *status;
+	int64_t code = 0;
+
+	if (!(record = list_next(args->iter)))
+		return DATA_FOR_EACH_FAIL;
+
+	if (!(status = data_resolve_dict_path(data, "/index/status")) ||
+	    data_get_int_converted(status, &code)) {
+		args->fail_cnt++;
+		return DATA_FOR_EACH_CONT;
+	}
 
-	return rc;
+	if ((code == 200) || (code == 201)) {
+		list_delete_item(args->iter);
+		args->success_cnt++;
+	} else {
+		log_flag(JOBCOMP, "HTTP status code %"PRId64" received indexing jobid %u",
+			 code, record->job_id);
+		args->fail_cnt++;
+	}
+
+	return DATA_FOR_EACH_CONT;
 }
 
-extern int jobcomp_p_log_record(job_record_t *job_ptr)
+/*
+ * Index a batch of jobs with a single _bulk request, location_mutex must be
+ * locked. Jobs indexed are removed from the batch.
+ */
+static void _index_bulk(list_t *batch)
 {
-	struct job_node *jnode = NULL;
-	data_t *record = NULL;
-	int rc;
+	list_itr_t *iter;
+	jobcomp_common_record_t *record;
+	bulk_items_args_t args = { 0 };
+	char *body = NULL, *pos = NULL, *response = NULL;
+	data_t *resp = NULL, *errors, *items;
+	int batch_cnt = list_count(batch);
+
+	iter = list_iterator_create(batch);
+	while ((record = list_next(iter))) {
+		xstrcatat(body, &pos, BULK_ACTION);
+		xstrcatat(body, &pos, record->payload);
+		xstrcatat(body, &pos, "\n");
+	}
+	list_iterator_destroy(iter);
 
-	if (list_count(jobslist) > MAX_JOBS) {
-		error("%s: Limit of %d enqueued jobs in memory waiting to be indexed reached. %pJ discarded",
-		      plugin_type, MAX_JOBS, job_ptr);
-		return SLURM_ERROR;
+	if (_post(bulk_url, "application/x-ndjson", body, &response))
+		goto cleanup;
+
+	if (serialize_g_string_to_data(&resp, response, strlen(response),
+				       MIME_TYPE_JSON) || !resp) {
+		error("%s: unable to parse _bulk response from %s",
+		      plugin_type, bulk_url);
+		goto cleanup;
 	}
 
-	record = jobcomp_common_job_record_to_data(job_ptr);
-	jnode = xmalloc(sizeof(struct job_node));
-	if ((rc = serialize_g_data_to_string(&jnode->serialized_job, NULL,
-					     record, MIME_TYPE_JSON,
-					     SER_FLAGS_COMPACT))) {
-		xfree(jnode);
-		log_flag(JOBCOMP, "unable to serialize %pJ to JSON: %s",
-			 job_ptr, slurm_strerror(rc));
-	} else {
-		list_enqueue(jobslist, jnode);
+	if ((errors = data_key_get(resp, "errors")) && !data_get_bool(errors)) {
+		list_flush(batch);
+		args.success_cnt = batch_cnt;
+	} else if ((items = data_key_get(resp, "items")) &&
+		   (data_get_type(items) == DATA_TYPE_LIST)) {
+		/* Items are in the order of the request, keep the failed */
+		args.iter = list_iterator_create(batch);
+		(void) data_list_for_each(items, _foreach_bulk_item, &args);
+		list_iterator_destroy(args.iter);
 	}
 
-	FREE_NULL_DATA(record);
-	return rc;
+	log_flag(JOBCOMP, "index success:%d fail:%d",
+		 args.success_cnt, (batch_cnt - args.success_cnt));
+
+cleanup:
+	FREE_NULL_DATA(resp);
+	xfree(response);
+	xfree(body);
 }
 
-extern void *_process_jobs(void *x)
+/* Callback of the common batch thread */
+static void _send_batch(list_t *batch)
 {
 	list_itr_t *iter;
-	struct job_node *jnode = NULL;
-	struct timespec ts = {0, 0};
-	time_t now;
+	jobcomp_common_record_t *record;
 
-	/* Wait for jobcomp_p_set_location log_url setup. */
 	slurm_mutex_lock(&location_mutex);
-	ts.tv_sec = time(NULL) + INDEX_RETRY_INTERVAL;
-	slurm_cond_timedwait(&location_cond, &location_mutex, &ts);
+	if (!log_url) {
+		/* jobcomp_p_set_location() not called yet, keep for later */
+	} else if (bulk_url) {
+		_index_bulk(batch);
+	} else {
+		/* Stop at the first failure to keep the order */
+		iter = list_iterator_create(batch);
+		while ((record = list_next(iter)) && !_index_job(record))
+			list_delete_item(iter);
+		list_iterator_destroy(iter);
+	}
 	slurm_mutex_unlock(&location_mutex);
+}
 
-	while (!thread_shutdown) {
-		int success_cnt = 0, fail_cnt = 0, wait_retry_cnt = 0;
-		sleep(1);
-		iter = list_iterator_create(jobslist);
-		while ((jnode = (struct job_node *)list_next(iter)) &&
-		       !thread_shutdown) {
-			now = time(NULL);
-			if ((jnode->last_index_retry == 0) ||
-			    (difftime(now, jnode->last_index_retry) >=
-					INDEX_RETRY_INTERVAL)) {
-				if ((_index_job(jnode->serialized_job) ==
-				     SLURM_SUCCESS)) {
-					list_delete_item(iter);
-					success_cnt++;
-				} else {
-					jnode->last_index_retry = now;
-					fail_cnt++;
-				}
-			} else
-				wait_retry_cnt++;
-		}
-		list_iterator_destroy(iter);
-		if ((success_cnt || fail_cnt))
-			log_flag(JOBCOMP, "index success:%d fail:%d wait_retry:%d",
-				 success_cnt, fail_cnt,
-				 wait_retry_cnt);
+/* Saves the state of all jobcomp data for further indexing retries */
+static int _save_state(list_t *pending)
+{
+	int rc = SLURM_SUCCESS;
+	list_itr_t *iter;
+	static int high_buffer_size = (1024 * 1024);
+	buf_t *buffer = init_buf(high_buffer_size);
+	uint32_t job_cnt;
+	jobcomp_common_record_t *record;
+
+	job_cnt = list_count(pending);
+	pack32(job_cnt, buffer);
+	iter = list_iterator_create(pending);
+	while ((record = list_next(iter))) {
+		packstr(record->payload, buffer);
 	}
-	return NULL;
+	list_iterator_destroy(iter);
+
+	slurm_mutex_lock(&save_lock);
+	jobcomp_common_write_state_file(buffer, save_state_file);
+	slurm_mutex_unlock(&save_lock);
+
+	FREE_NULL_BUFFER(buffer);
+
+	return rc;
 }
 
-static void _jobslist_del(void *x)
+extern int jobcomp_p_log_record(job_record_t *job_ptr)
 {
-	struct job_node *jnode = (struct job_node *) x;
-	xfree(jnode->serialized_job);
-	xfree(jnode);
+	return jobcomp_common_batch_add(job_ptr);
 }
 
 /*
@@ -410,23 +452,22 @@ extern int init(void)
 		return rc;
 	}
 
-	jobslist = list_create(_jobslist_del);
-	slurm_thread_create(&job_handler_thread, _process_jobs, NULL);
-	slurm_mutex_lock(&pend_jobs_lock);
+	jobcomp_common_batch_init(_send_batch, BATCH_MAX_RECORDS,
+				  BATCH_MAX_BYTES);
 	(void) _load_pending_jobs();
-	slurm_mutex_unlock(&pend_jobs_lock);
 
 	return SLURM_SUCCESS;
 }
 
 extern int fini(void)
 {
-	thread_shutdown = true;
-	slurm_thread_join(job_handler_thread);
+	list_t *pending = jobcomp_common_batch_fini();
 
-	_save_state();
-	FREE_NULL_LIST(jobslist);
+	if (pending)
+		_save_state(pending);
+	FREE_NULL_LIST(pending);
 	xfree(log_url);
+	xfree(bulk_url);
 	return SLURM_SUCCESS;
 }
 
@@ -438,6 +479,7 @@ extern int jobcomp_p_set_location(void)
 {
 	char *location = slurm_conf.job_comp_loc;
 	int rc = SLURM_SUCCESS;
+	size_t len;
 
 	if (location == NULL) {
 		error("%s: JobCompLoc parameter not configured", plugin_type);
@@ -448,9 +490,18 @@ extern int jobcomp_p_set_location(void)
 	if (log_url)
 		xfree(log_url);
 	log_url = xstrdup(location);
-	slurm_cond_broadcast(&location_cond);
+	xfree(bulk_url);
+	if ((len = strlen(log_url)) > 5 &&
+	    !xstrcmp(log_url + len - 5, "/_doc")) {
+		/* Index in batches through the _bulk API of the same index */
+		bulk_url = xstrndup(log_url, len - 5);
+		xstrcat(bulk_url, "/_bulk");
+	}
 	slurm_mutex_unlock(&location_mutex);
 
+	/* Records queued before now may be waiting out a retry backoff */
+	jobcomp_common_batch_wake();
+
 	return rc;
 }
 
@@ -126,33 +126,8 @@ extern int jobcomp_p_set_location(void)
 
 extern int jobcomp_p_log_record(job_record_t *job_ptr)
 {
-	int rc = SLURM_SUCCESS;
-	char *job_record_serialized = NULL;
-	data_t *job_record_data = NULL;
-
-	if (!(job_record_data = jobcomp_common_job_record_to_data(job_ptr))) {
-		error("%s: unable to build data_t. %pJ discarded",
-		      plugin_type, job_ptr);
-		rc = SLURM_ERROR;
-		goto end;
-	}
-
-	if ((rc = serialize_g_data_to_string(&job_record_serialized,
-					     NULL,
-					     job_record_data,
-					     MIME_TYPE_JSON,
-					     SER_FLAGS_COMPACT))) {
-		error("%s: %pJ discarded, unable to serialize to JSON: %s",
-		      plugin_type, job_ptr, slurm_strerror(rc));
-		goto end;
-	}
-
-	jobcomp_kafka_message_produce(job_ptr->job_id, job_record_serialized);
-
-end:
-	xfree(job_record_serialized);
-	FREE_NULL_DATA(job_record_data);
-	return rc;
+	/* Produced to librdkafka from the jobcomp common batch thread */
+	return jobcomp_common_batch_add(job_ptr);
 }
 
 extern list_t *jobcomp_p_get_jobs(void *job_cond)
@@ -49,6 +49,8 @@
 #include "src/plugins/jobcomp/kafka/jobcomp_kafka_message.h"
 
 #define KAFKA_STATE_FILE "jobcomp_kafka_state"
+#define KAFKA_BATCH_MAX_RECORDS 1000 /* msgs produced per batch at most */
+#define KAFKA_BATCH_MAX_BYTES (10 * 1024 * 1024) /* bytes per batch at most */
 
 
 static pthread_mutex_t poll_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -78,11 +80,13 @@ static void _dump_rd_kafka_conf(rd_kafka_conf_t *conf);
 static void _flush_rd_kafka_msgs(void);
 static int _foreach_conf_pair(void *x, void *arg);
 static kafka_msg_t *_init_kafka_msg(uint32_t job_id, char *payload);
+static int _foreach_pending_msg(void *x, void *arg);
 static void _load_jobcomp_kafka_state(void);
 static void _pack_jobcomp_kafka_state(buf_t *buffer);
 static int _pack_kafka_msg(void *object, void *arg);
 static void *_poll_handler(void *no_data);
 static void _purge_rd_kafka_msgs(void);
+static void _send_batch(list_t *batch);
 static void _terminate_poll_handler(void);
 static void _save_jobcomp_kafka_state(void);
 static rd_kafka_conf_t *_set_rd_kafka_conf(void);
@@ -194,11 +198,14 @@ static void _dr_msg_cb(rd_kafka_t *rk, const rd_kafka_message_t *rkmessage,
 		slurm_rwlock_unlock(&kafka_conf_rwlock);
 
 		if (requeue) {
-			if (!terminate) {
-				jobcomp_kafka_message_produce(job_id, payload);
+			char *copy = xstrdup(payload);
+
+			if (!terminate &&
+			    !jobcomp_common_batch_add_payload(job_id, &copy)) {
 				xstrfmtcat(action_str,
 					"Attempting to produce message again");
 			} else {
+				xfree(copy);
 				_add_kafka_msg_to_state(job_id,
 							xstrdup(payload));
 				xstrfmtcat(action_str,
@@ -540,8 +547,11 @@ static int _unpack_jobcomp_kafka_msg(uint16_t protocol_version, buf_t *buffer)
 	safe_unpack32(&job_id, buffer);
 	safe_unpackstr(&payload, buffer);
 
-	jobcomp_kafka_message_produce(job_id, payload);
-	xfree(payload);
+	if (jobcomp_common_batch_add_payload(job_id, &payload)) {
+		error("%s: Unable to queue JobId=%u message loaded from state file. Message discarded.",
+		      plugin_type, job_id);
+		xfree(payload);
+	}
 
 	return SLURM_SUCCESS;
 
@@ -605,6 +615,38 @@ static void _save_jobcomp_kafka_state(void)
 	FREE_NULL_BUFFER(buffer);
 }
 
+/* Move a record never produced to the state file list. */
+static int _foreach_pending_msg(void *x, void *arg)
+{
+	jobcomp_common_record_t *record = x;
+
+	_add_kafka_msg_to_state(record->job_id, record->payload);
+	record->payload = NULL;
+
+	return 0;
+}
+
+/*
+ * Produce a batch of messages to librdkafka, from the jobcomp common batch
+ * thread. Stop when the librdkafka queue is full so the rest is produced again
+ * once it drained, instead of being discarded.
+ */
+static void _send_batch(list_t *batch)
+{
+	list_itr_t *iter;
+	jobcomp_common_record_t *record;
+
+	iter = list_iterator_create(batch);
+	while ((record = list_next(iter))) {
+		if (jobcomp_kafka_message_produce(record->job_id,
+						  record->payload) ==
+		    RD_KAFKA_RESP_ERR__QUEUE_FULL)
+			break;
+		list_delete_item(iter);
+	}
+	list_iterator_destroy(iter);
+}
+
 static void _terminate_poll_handler(void)
 {
 	slurm_mutex_lock(&poll_mutex);
@@ -620,6 +662,8 @@ extern int jobcomp_kafka_message_init(void)
 		return SLURM_ERROR;
 
 	state_msg_list = list_create(_destroy_kafka_msg);
+	jobcomp_common_batch_init(_send_batch, KAFKA_BATCH_MAX_RECORDS,
+				  KAFKA_BATCH_MAX_BYTES);
 	_load_jobcomp_kafka_state();
 	slurm_thread_create(&poll_thread, _poll_handler, NULL);
 
@@ -628,10 +672,15 @@ extern int jobcomp_kafka_message_init(void)
 
 extern void jobcomp_kafka_message_fini(void)
 {
+	list_t *pending = jobcomp_common_batch_fini();
+
 	_terminate_poll_handler();
 	_purge_rd_kafka_msgs();
 	_flush_rd_kafka_msgs();
 	_destroy_rd_kafka_handle();
+	if (pending)
+		(void) list_for_each(pending, _foreach_pending_msg, NULL);
+	FREE_NULL_LIST(pending);
 	_save_jobcomp_kafka_state();
 	FREE_NULL_LIST(state_msg_list);
 }
@@ -641,8 +690,11 @@ extern void jobcomp_kafka_message_fini(void)
  *
  * IN: uint32_t job_id
  * IN: char *payload
+ * RET: RD_KAFKA_RESP_ERR__QUEUE_FULL if the message should be produced again
+ * later, message produced or discarded otherwise.
  */
-extern void jobcomp_kafka_message_produce(uint32_t job_id, char *payload)
+extern rd_kafka_resp_err_t jobcomp_kafka_message_produce(uint32_t job_id,
+							 char *payload)
 {
 	uint32_t *opaque = NULL;
 	size_t len;
@@ -680,6 +732,10 @@ extern void jobcomp_kafka_message_produce(uint32_t job_id, char *payload)
 		log_flag(JOBCOMP, "Produced JobId=%u message for topic '%s' to librdkafka queue.",
 			 job_id, kafka_conf->topic);
 		/* Do not xfree(opaque). Delivery msg callback will do it. */
+	} else if (err == RD_KAFKA_RESP_ERR__QUEUE_FULL) {
+		log_flag(JOBCOMP, "librdkafka queue full, JobId=%u message for topic '%s' will be produced again later.",
+			 job_id, kafka_conf->topic);
+		xfree(opaque);
 	} else {
 		error("%s: Failed to produce JobId=%u message for topic '%s': %s. Message discarded.",
 		      plugin_type, job_id, kafka_conf->topic,
@@ -687,4 +743,6 @@ extern void jobcomp_kafka_message_produce(uint32_t job_id, char *payload)
 		xfree(opaque);
 	}
 	slurm_rwlock_unlock(&kafka_conf_rwlock);
+
+	return err;
 }
@@ -46,6 +46,7 @@ typedef struct {
 
 extern int jobcomp_kafka_message_init(void);
 extern void jobcomp_kafka_message_fini(void);
-extern void jobcomp_kafka_message_produce(uint32_t job_id, char *payload);
+extern rd_kafka_resp_err_t jobcomp_kafka_message_produce(uint32_t job_id,
+							 char *payload);
 
 #endif
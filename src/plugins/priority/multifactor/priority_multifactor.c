@@ -64,6 +64,8 @@
 #include "src/interfaces/mcs.h"
 #include "src/interfaces/priority.h"
 #include "src/common/slurm_time.h"
+#include "src/common/timers.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 #include "src/interfaces/gres.h"
 
@@ -88,6 +90,8 @@ extern slurm_conf_t slurm_conf __attribute__((weak_import));
 extern int slurmctld_tres_cnt __attribute__((weak_import));
 extern uint16_t accounting_enforce __attribute__((weak_import));
 extern int active_node_record_count __attribute__((weak_import));
+extern time_t last_part_update __attribute__((weak_import));
+extern diag_stats_t slurmctld_diag_stats __attribute__((weak_import));
 #else
 void *acct_db_conn = NULL;
 uint32_t cluster_cpus = NO_VAL;
@@ -97,6 +101,8 @@ slurm_conf_t slurm_conf;
 int slurmctld_tres_cnt = 0;
 uint16_t accounting_enforce = 0;
 int active_node_record_count;
+time_t last_part_update = (time_t) 0;
+diag_stats_t slurmctld_diag_stats;
 #endif
 
 /*
@@ -149,6 +155,26 @@ static uint32_t flags;       /* Priority Flags */
 static time_t g_last_ran = 0; /* when the last poll ran */
 static double decay_factor = 1; /* The decay factor when decaying time. */
 
+/*
+ * Inputs of a job's last priority calculation which may change without the
+ * job being updated. Used with PriorityParameters=incremental_decay to skip
+ * recalculating priorities which would not change.
+ */
+typedef struct {
+	uint32_t job_id;
+	uint32_t prio_gen;	/* prio_gen at time of calculation */
+	time_t accrue_time;
+	bool age_max;		/* age factor was at its maximum */
+	double priority_fs;	/* fairshare factor, before weight */
+	uint32_t site_factor;
+	uint32_t total_cpus;
+} job_prio_calc_t;
+
+static bool incr_decay = false;	/* PriorityParameters=incremental_decay */
+static xhash_t *job_prio_calc = NULL;	/* job_prio_calc_t, by job_id */
+static uint32_t prio_gen = 0;	/* increment to recalculate all jobs */
+static uint32_t decay_jobs_calc = 0, decay_jobs_skipped = 0;
+
 /* variables defined in priority_multifactor.h */
 
 static void _priority_p_set_assoc_usage_debug(slurmdb_assoc_rec_t *assoc);
@@ -528,6 +554,149 @@ static double _get_tres_prio_weighted(double *tres_factors)
 	return tmp_tres;
 }
 
+static void _job_prio_calc_id(void *item, const char **key,
+			      uint32_t *key_len)
+{
+	job_prio_calc_t *calc = item;
+
+	*key = (const char *) &calc->job_id;
+	*key_len = sizeof(calc->job_id);
+}
+
+static bool _age_at_max(time_t start_time, job_record_t *job_ptr)
+{
+	if (!weight_age)
+		return true;
+	if (!job_ptr->details->accrue_time ||
+	    (start_time <= job_ptr->details->accrue_time))
+		return false;
+	return ((start_time - job_ptr->details->accrue_time) >= max_age);
+}
+
+/*
+ * Remember the inputs of a job's priority calculation so that the decay
+ * thread can skip it while they remain unchanged.
+ * job_write_lock must be locked before calling this.
+ */
+static void _save_prio_calc(time_t start_time, job_record_t *job_ptr)
+{
+	job_prio_calc_t *calc;
+
+	if (!incr_decay || !job_ptr->job_id)
+		return;
+
+	if (!job_prio_calc)
+		job_prio_calc = xhash_init(_job_prio_calc_id, xfree_ptr);
+
+	if (!(calc = xhash_get(job_prio_calc, (char *) &job_ptr->job_id,
+			       sizeof(job_ptr->job_id)))) {
+		calc = xmalloc(sizeof(*calc));
+		calc->job_id = job_ptr->job_id;
+		xhash_add(job_prio_calc, calc);
+	}
+
+	calc->prio_gen = prio_gen;
+	calc->accrue_time = job_ptr->details->accrue_time;
+	calc->age_max = _age_at_max(start_time, job_ptr);
+	calc->priority_fs = job_ptr->prio_factors->priority_fs;
+	calc->site_factor = job_ptr->site_factor;
+	calc->total_cpus = job_ptr->total_cpus;
+}
+
+/*
+ * Return true if none of the inputs of the job's last priority calculation
+ * has changed, so its priority would be recalculated to the same value.
+ * job_write_lock must be locked before calling this.
+ */
+static bool _prio_calc_current(time_t start_time, job_record_t *job_ptr)
+{
+	job_prio_calc_t *calc;
+	double priority_fs = 0.0;
+
+	if (!job_prio_calc || !job_ptr->prio_factors || !job_ptr->details ||
+	    job_ptr->direct_set_prio)
+		return false;
+
+	if (!(calc = xhash_get(job_prio_calc, (char *) &job_ptr->job_id,
+			       sizeof(job_ptr->job_id))))
+		return false;
+
+	if ((calc->prio_gen != prio_gen) ||
+	    (calc->accrue_time != job_ptr->details->accrue_time) ||
+	    (calc->site_factor != job_ptr->site_factor) ||
+	    (calc->total_cpus != job_ptr->total_cpus) ||
+	    !calc->age_max || !_age_at_max(start_time, job_ptr))
+		return false;
+
+	if (job_ptr->assoc_ptr && weight_fs)
+		priority_fs = _get_fairshare_priority(job_ptr);
+	if (priority_fs != calc->priority_fs)
+		return false;
+
+	return true;
+}
+
+/*
+ * Start a new generation of priority calculations, so every job is
+ * recalculated by the decay thread, if anything outside of the jobs
+ * themselves that their priority depends upon has changed.
+ */
+static void _update_prio_gen(void)
+{
+	static time_t last_part_gen = 0;
+	static uint32_t last_cluster_cpus = 0;
+	static int last_node_cnt = 0;
+	static uint64_t last_assoc_hash = 0;
+	uint64_t assoc_hash = 0xcbf29ce484222325ULL;
+	slurmdb_assoc_rec_t *assoc;
+	slurmdb_qos_rec_t *qos;
+	list_itr_t *itr;
+	assoc_mgr_lock_t locks = { .assoc = READ_LOCK, .qos = READ_LOCK };
+
+	/* FNV-1a over the association and QOS values used by priority */
+#define HASH_VAL(val) do {						\
+		uint64_t _v = 0;					\
+		memcpy(&_v, &(val), MIN(sizeof(val), sizeof(_v)));	\
+		assoc_hash = (assoc_hash ^ _v) * 0x100000001b3ULL;	\
+	} while (0)
+
+	assoc_mgr_lock(&locks);
+	if (assoc_mgr_assoc_list) {
+		itr = list_iterator_create(assoc_mgr_assoc_list);
+		while ((assoc = list_next(itr))) {
+			HASH_VAL(assoc->id);
+			HASH_VAL(assoc->priority);
+			HASH_VAL(assoc->shares_raw);
+			if (assoc->usage)
+				HASH_VAL(assoc->usage->priority_norm);
+		}
+		list_iterator_destroy(itr);
+	}
+	if (assoc_mgr_qos_list) {
+		itr = list_iterator_create(assoc_mgr_qos_list);
+		while ((qos = list_next(itr))) {
+			HASH_VAL(qos->id);
+			HASH_VAL(qos->priority);
+			if (qos->usage)
+				HASH_VAL(qos->usage->norm_priority);
+		}
+		list_iterator_destroy(itr);
+	}
+	assoc_mgr_unlock(&locks);
+#undef HASH_VAL
+
+	if ((last_part_gen != last_part_update) ||
+	    (last_cluster_cpus != cluster_cpus) ||
+	    (last_node_cnt != active_node_record_count) ||
+	    (last_assoc_hash != assoc_hash)) {
+		prio_gen++;
+		last_part_gen = last_part_update;
+		last_cluster_cpus = cluster_cpus;
+		last_node_cnt = active_node_record_count;
+		last_assoc_hash = assoc_hash;
+	}
+}
+
 /* Returns the priority after applying the weight factors */
 static uint32_t _get_priority_internal(time_t start_time,
 				       job_record_t *job_ptr)
@@ -562,6 +731,7 @@ static uint32_t _get_priority_internal(time_t start_time,
 	}
 
 	set_priority_factors(start_time, job_ptr);
+	_save_prio_calc(start_time, job_ptr);
 
 	if (slurm_conf.debug_flags & DEBUG_FLAG_PRIO) {
 		memcpy(&pre_factors, job_ptr->prio_factors,
@@ -1223,6 +1393,7 @@ static void *_decay_thread(void *no_data)
 	double run_delta = 0.0, real_decay = 0.0;
 	struct timeval tvnow;
 	struct timespec abs;
+	DEF_TIMERS;
 
 	/* Write lock on jobs, read lock on nodes and partitions */
 	slurmctld_lock_t job_write_lock =
@@ -1293,6 +1464,9 @@ static void *_decay_thread(void *no_data)
 
 		slurm_mutex_lock(&decay_lock);
 		running_decay = 1;
+		START_TIMER;
+		decay_jobs_calc = 0;
+		decay_jobs_skipped = 0;
 
 		/* If reconfig is called handle all that happens
 		   outside of the loop here */
@@ -1311,6 +1485,7 @@ static void *_decay_thread(void *no_data)
 				decay_factor = 1;
 
 			reconfig = 0;
+			prio_gen++;
 		}
 
 		/* this needs to be done right away so as to
@@ -1350,6 +1525,9 @@ static void *_decay_thread(void *no_data)
 			assoc_mgr_unlock(&locks);
 		}
 
+		if (incr_decay)
+			_update_prio_gen();
+
 		if (!g_last_ran)
 			goto get_usage;
 		else
@@ -1399,6 +1577,17 @@ static void *_decay_thread(void *no_data)
 
 		_write_last_decay_ran(g_last_ran, last_reset);
 
+		END_TIMER;
+		slurmctld_diag_stats.decay_cycle_counter++;
+		slurmctld_diag_stats.decay_cycle_last = DELTA_TIMER;
+		slurmctld_diag_stats.decay_cycle_sum += DELTA_TIMER;
+		if (DELTA_TIMER > slurmctld_diag_stats.decay_cycle_max)
+			slurmctld_diag_stats.decay_cycle_max = DELTA_TIMER;
+		slurmctld_diag_stats.decay_jobs_calc = decay_jobs_calc;
+		slurmctld_diag_stats.decay_jobs_skipped = decay_jobs_skipped;
+		log_flag(PRIO, "Decay cycle took %s, %u job priorities calculated, %u skipped",
+			 TIME_STR, decay_jobs_calc, decay_jobs_skipped);
+
 		running_decay = 0;
 
 		/* Sleep until the next time. */
@@ -1470,6 +1659,11 @@ static void _internal_setup(void)
 	weight_tres = slurm_get_tres_weight_array(
 		slurm_conf.priority_weight_tres, slurmctld_tres_cnt, true);
 	flags = slurm_conf.priority_flags;
+	if (xstrcasestr(slurm_conf.priority_params, "incremental_decay"))
+		incr_decay = true;
+	else
+		incr_decay = false;
+	prio_gen++;
 
 	log_flag(PRIO, "priority: Damp Factor is %u", damp_factor);
 	log_flag(PRIO, "priority: AccountingStorageEnforce is %u",
@@ -1482,6 +1676,8 @@ static void _internal_setup(void)
 	log_flag(PRIO, "priority: Weight Part is %u", weight_part);
 	log_flag(PRIO, "priority: Weight QOS is %u", weight_qos);
 	log_flag(PRIO, "priority: Flags is %u", flags);
+	log_flag(PRIO, "priority: Incremental decay is %s",
+		 incr_decay ? "enabled" : "disabled");
 }
 
 
@@ -1712,6 +1908,8 @@ int fini ( void )
 
 	site_factor_g_fini();
 
+	xhash_free(job_prio_calc);
+
 	return SLURM_SUCCESS;
 }
 
@@ -1913,6 +2111,10 @@ extern void priority_p_job_end(job_record_t *job_ptr)
 {
 	log_flag(PRIO, "%s: called for job %u", __func__, job_ptr->job_id);
 
+	if (job_prio_calc)
+		xhash_delete(job_prio_calc, (char *) &job_ptr->job_id,
+			     sizeof(job_ptr->job_id));
+
 	_apply_new_usage(job_ptr, g_last_ran, time(NULL), 1);
 }
 
@@ -1951,8 +2153,18 @@ extern int decay_apply_weighted_factors(job_record_t *job_ptr,
 	if ((job_ptr->priority == 0) ||
 	    IS_JOB_POWER_UP_NODE(job_ptr) ||
 	    (!IS_JOB_PENDING(job_ptr) &&
-	     !(flags & PRIORITY_FLAGS_CALCULATE_RUNNING)))
+	     !(flags & PRIORITY_FLAGS_CALCULATE_RUNNING))) {
+		if (job_prio_calc && !IS_JOB_PENDING(job_ptr))
+			xhash_delete(job_prio_calc, (char *) &job_ptr->job_id,
+				     sizeof(job_ptr->job_id));
 		return SLURM_SUCCESS;
+	}
+
+	if (incr_decay && _prio_calc_current(*start_time_ptr, job_ptr)) {
+		decay_jobs_skipped++;
+		return SLURM_SUCCESS;
+	}
+	decay_jobs_calc++;
 
 	new_prio = _get_priority_internal(*start_time_ptr, job_ptr);
 	if (((flags & PRIORITY_FLAGS_INCR_ONLY) == 0) ||
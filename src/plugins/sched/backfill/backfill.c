@@ -1737,6 +1737,21 @@ static void _handle_planned(bool set)
 		last_node_update = time(NULL);
 }
 
+/*
+ * Remember the shape of a job which could not be backfilled in this cycle
+ * along with its expected start time, 0 if none was computed
+ */
+static void _add_failed_shape(xhash_t *failed_shapes, char **shape_sig,
+			      job_record_t *job_ptr, time_t start_time)
+{
+	if (!*shape_sig)
+		return;
+
+	job_shape_cache_add(failed_shapes, *shape_sig, job_ptr->state_reason,
+			    start_time);
+	*shape_sig = NULL;
+}
+
 static void _attempt_backfill(void)
 {
 	DEF_TIMERS;
@@ -1778,6 +1793,8 @@ static void _attempt_backfill(void)
 	bitstr_t *tmp_bitmap = NULL;
 	bool state_changed_break = false;
 	resv_exc_t resv_exc = { 0 };
+	xhash_t *failed_shapes = NULL;
+	char *shape_sig = NULL;
 	/* QOS Read lock */
 	assoc_mgr_lock_t qos_read_lock = {
 		.qos = READ_LOCK,
@@ -1875,6 +1892,7 @@ static void _attempt_backfill(void)
 	}
 
 	sort_job_queue(job_queue);
+	failed_shapes = job_shape_cache_init();
 
 	/* Ignore nodes that have been set as available during this cycle. */
 	bit_clear_all(bf_ignore_node_bitmap);
@@ -1973,6 +1991,8 @@ static void _attempt_backfill(void)
 				_set_bf_exit(BF_EXIT_STATE_CHANGED);
 				break;
 			}
+			/* Resources may have been released while yielding */
+			xhash_clear(failed_shapes);
 			/* Reset backfill scheduling timers, resume testing */
 			sched_start = time(NULL);
 			gettimeofday(&start_tv, NULL);
@@ -2256,6 +2276,35 @@ next_task:
 			deadline_time_limit = (job_ptr->deadline - now) / 60;
 		}
 
+		/*
+		 * Skip jobs identical to one which could not be backfilled
+		 * since the last lock yield, the plan only got fuller since.
+		 */
+		xfree(shape_sig);
+		if ((shape_sig = job_shape_sig(job_ptr, use_prefer))) {
+			job_shape_t *failed_shape;
+
+			xstrfmtcat(shape_sig, "|%u", job_no_reserve);
+			if ((failed_shape = xhash_get_str(failed_shapes,
+							  shape_sig))) {
+				log_flag(BACKFILL, "%pJ has the same shape as a job which could not be backfilled",
+					 job_ptr);
+				slurmctld_diag_stats.bf_shape_hits++;
+				/*
+				 * It can not start before the job tested, use
+				 * its estimate unless starting earlier in a
+				 * different partition.
+				 */
+				if (failed_shape->start_time &&
+				    (!orig_start_time ||
+				     (orig_start_time >=
+				      failed_shape->start_time)))
+					job_ptr->start_time =
+						failed_shape->start_time;
+				continue;
+			}
+		}
+
 		/* Determine job's expected completion time */
 		if (part_ptr->max_time == INFINITE)
 			part_time_limit = YEAR_MINUTES;
@@ -2335,6 +2384,8 @@ next_task:
 				_set_bf_exit(BF_EXIT_STATE_CHANGED);
 				break;
 			}
+			/* Resources may have been released while yielding */
+			xhash_clear(failed_shapes);
 
 			/* Reset backfill scheduling timers, resume testing */
 			sched_start = time(NULL);
@@ -2532,6 +2583,8 @@ next_task:
 			 * start in different partition it will be 0
 			 */
 			job_ptr->start_time = orig_start_time;
+			_add_failed_shape(failed_shapes, &shape_sig, job_ptr,
+					  0);
 			continue;
 		}
 
@@ -2658,6 +2711,8 @@ next_task:
 				goto TRY_LATER;
 			}
 			job_ptr->start_time = orig_start_time;
+			_add_failed_shape(failed_shapes, &shape_sig, job_ptr,
+					  0);
 			continue;	/* not runable in this partition */
 		}
 
@@ -2957,6 +3012,8 @@ skip_start:
 			      backfill_resolution;
 
 		if (job_ptr->start_time > (sched_start + backfill_window)) {
+			time_t shape_start_time = job_ptr->start_time;
+
 			/* Starts too far in the future to worry about */
 			if (slurm_conf.debug_flags & DEBUG_FLAG_BACKFILL)
 				_dump_job_sched(job_ptr, end_reserve,
@@ -2970,6 +3027,8 @@ skip_start:
 					 job_ptr);
 			}
 			_set_job_time_limit(job_ptr, orig_time_limit);
+			_add_failed_shape(failed_shapes, &shape_sig, job_ptr,
+					  shape_start_time);
 			continue;
 		}
 
@@ -3178,6 +3237,8 @@ skip_start:
 	FREE_NULL_BITMAP(avail_bitmap);
 	reservation_delete_resv_exc_parts(&resv_exc);
 	FREE_NULL_BITMAP(resv_bitmap);
+	xhash_free(failed_shapes);
+	xfree(shape_sig);
 
 	for (i = 0; ; ) {
 		FREE_NULL_BITMAP(node_space[i].avail_bitmap);
@@ -383,6 +383,7 @@ extern int job_res_add_job(job_record_t *job_ptr, job_res_job_action_t action)
 			       job_ptr,
 			       p_ptr->part_ptr->name, i);
 			part_data_add_job_to_row(job, &(p_ptr->row[i]));
+			part_data_alloc_cores_invalidate(job->node_bitmap);
 			break;
 		}
 		if (i >= p_ptr->num_rows) {
@@ -562,6 +563,9 @@ extern int job_res_rm_job(part_res_record_t *part_record_ptr,
 		if (n) {
 			/* job was found and removed, so refresh the bitmaps */
 			part_data_build_row_bitmaps(p_ptr, job_ptr);
+			if (part_record_ptr == select_part_record)
+				part_data_alloc_cores_invalidate(
+					job->node_bitmap);
 			/*
 			 * Adjust the node_state of all nodes affected by
 			 * the removal of this job. If all cores are now
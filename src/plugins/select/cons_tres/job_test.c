@@ -42,8 +42,12 @@
 #include "gres_select_util.h"
 #include "gres_sock_list.h"
 
+#include "src/common/workq.h"
+#include "src/common/xhash.h"
 #include "src/slurmctld/licenses.h"
 
+#define RES_AVAIL_CHUNK 128	/* Nodes evaluated per work item */
+
 typedef struct {
 	int action;
 	list_t *license_list;
@@ -54,7 +58,7 @@ typedef struct {
 } wrapper_rm_job_args_t;
 
 typedef struct {
-	List preemptee_candidates;
+	xhash_t *preemptee_hash;
 	List cr_job_list;
 	node_use_record_t *future_usage;
 	part_res_record_t *future_part;
@@ -63,11 +67,38 @@ typedef struct {
 	bool *qos_preemptor;
 } cr_job_list_args_t;
 
+typedef struct {
+	job_record_t *job_ptr;
+	bitstr_t *node_map;
+	bitstr_t **core_map;
+	node_use_record_t *node_usage;
+	uint16_t cr_type;
+	bool test_only;
+	bool will_run;
+	bitstr_t **part_core_map;
+	resv_exc_t *resv_exc_ptr;
+	uint32_t s_p_n;
+	avail_res_t **avail_res_array;
+	int pending;		/* Count of chunks not yet evaluated */
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+} res_avail_args_t;
+
+typedef struct {
+	res_avail_args_t *args;
+	int i_first;
+	int i_last;
+} res_avail_chunk_t;
+
 uint64_t def_cpu_per_gpu = 0;
 uint64_t def_mem_per_gpu = 0;
 bool preempt_strict_order = false;
 bool preempt_for_licenses = false;
 int preempt_reorder_cnt	= 1;
+int select_eval_threads = 0;
+bool select_eval_verify = false;
+
+static workq_t *res_avail_workq = NULL;
 
 /* Local functions */
 static avail_res_t *_allocate(job_record_t *job_ptr,
@@ -218,14 +249,6 @@ static int _cr_job_list_sort(void *x, void *y)
 	return (int) (job1_ptr->end_time - job2_ptr->end_time);
 }
 
-static int _find_job (void *x, void *key)
-{
-	job_record_t *job_ptr = (job_record_t *) x;
-	if (job_ptr == (job_record_t *) key)
-		return 1;
-	return 0;
-}
-
 static void _free_avail_res(avail_res_t *avail_res)
 {
 	if (!avail_res)
@@ -571,6 +594,145 @@ static avail_res_t *_can_job_run_on_node(job_record_t *job_ptr,
 	return avail_res;
 }
 
+/* Evaluate the nodes of args->node_map in the range [i_first, i_last] */
+static void _get_res_avail_range(res_avail_args_t *args, int i_first,
+				 int i_last)
+{
+	for (int i = i_first; i <= i_last; i++) {
+		if (bit_test(args->node_map, i))
+			args->avail_res_array[i] =
+				_can_job_run_on_node(
+					args->job_ptr, args->core_map, i,
+					args->s_p_n, args->node_usage,
+					args->cr_type, args->test_only,
+					args->will_run, args->part_core_map,
+					args->resv_exc_ptr);
+	}
+}
+
+static void _get_res_avail_chunk(void *arg)
+{
+	res_avail_chunk_t *chunk = arg;
+	res_avail_args_t *args = chunk->args;
+
+	_get_res_avail_range(args, chunk->i_first, chunk->i_last);
+
+	slurm_mutex_lock(&args->mutex);
+	if (--args->pending == 0)
+		slurm_cond_signal(&args->cond);
+	slurm_mutex_unlock(&args->mutex);
+}
+
+/*
+ * Split the node range into chunks evaluated by res_avail_workq. Each node
+ * only touches its own entries of avail_res_array and core_map, so the result
+ * does not depend upon the order in which chunks complete.
+ */
+static void _get_res_avail_parallel(res_avail_args_t *args, int i_first,
+				    int i_last)
+{
+	int chunk_cnt = ((i_last - i_first) / RES_AVAIL_CHUNK) + 1;
+	res_avail_chunk_t *chunks = xcalloc(chunk_cnt, sizeof(*chunks));
+
+	slurm_mutex_init(&args->mutex);
+	slurm_cond_init(&args->cond, NULL);
+	args->pending = chunk_cnt - 1;
+
+	for (int c = 0; c < chunk_cnt; c++) {
+		chunks[c].args = args;
+		chunks[c].i_first = i_first + (c * RES_AVAIL_CHUNK);
+		chunks[c].i_last = MIN(chunks[c].i_first + RES_AVAIL_CHUNK - 1,
+				       i_last);
+	}
+
+	/* This thread evaluates the first chunk itself */
+	for (int c = 1; c < chunk_cnt; c++) {
+		if (workq_add_work(res_avail_workq, _get_res_avail_chunk,
+				   &chunks[c], "_get_res_avail_chunk"))
+			_get_res_avail_chunk(&chunks[c]);
+	}
+	_get_res_avail_range(args, chunks[0].i_first, chunks[0].i_last);
+
+	slurm_mutex_lock(&args->mutex);
+	while (args->pending)
+		slurm_cond_wait(&args->cond, &args->mutex);
+	slurm_mutex_unlock(&args->mutex);
+
+	slurm_mutex_destroy(&args->mutex);
+	slurm_cond_destroy(&args->cond);
+	xfree(chunks);
+}
+
+static bool _avail_res_equal(avail_res_t *a, avail_res_t *b)
+{
+	if (!a || !b)
+		return (a == b);
+
+	if ((a->avail_cpus != b->avail_cpus) ||
+	    (a->avail_gpus != b->avail_gpus) ||
+	    (a->avail_res_cnt != b->avail_res_cnt) ||
+	    (a->gres_min_cpus != b->gres_min_cpus) ||
+	    (a->gres_max_tasks != b->gres_max_tasks) ||
+	    (a->max_cpus != b->max_cpus) ||
+	    (a->min_cpus != b->min_cpus) ||
+	    (a->sock_cnt != b->sock_cnt) ||
+	    (a->spec_threads != b->spec_threads) ||
+	    (a->tpc != b->tpc) ||
+	    (list_count(a->sock_gres_list) != list_count(b->sock_gres_list)))
+		return false;
+
+	if (a->sock_cnt &&
+	    memcmp(a->avail_cores_per_sock, b->avail_cores_per_sock,
+		   sizeof(uint16_t) * a->sock_cnt))
+		return false;
+
+	return true;
+}
+
+/*
+ * Repeat a parallel evaluation serially on a copy of the original core_map
+ * and compare the results. Used with SchedulerParameters=select_eval_verify.
+ * On any difference the serial results replace the parallel ones.
+ */
+static void _verify_res_avail(res_avail_args_t *args, bitstr_t **orig_core_map,
+			      int i_first, int i_last)
+{
+	res_avail_args_t serial_args = *args;
+	int i;
+
+	serial_args.core_map = orig_core_map;
+	serial_args.avail_res_array = xcalloc(node_record_count,
+					      sizeof(avail_res_t *));
+	_get_res_avail_range(&serial_args, i_first, i_last);
+
+	for (i = i_first; i <= i_last; i++) {
+		bitstr_t *par_map = args->core_map[i];
+		bitstr_t *ser_map = orig_core_map[i];
+
+		if (!_avail_res_equal(args->avail_res_array[i],
+				      serial_args.avail_res_array[i]))
+			break;
+		if ((!par_map != !ser_map) ||
+		    (par_map && !bit_equal(par_map, ser_map)))
+			break;
+	}
+	if (i > i_last) {
+		_free_avail_res_array(serial_args.avail_res_array);
+		free_core_array(&orig_core_map);
+		return;
+	}
+
+	error("%s: parallel node evaluation of %pJ differs from serial on node %s, using serial results",
+	      __func__, args->job_ptr, node_record_table_ptr[i]->name);
+	_free_avail_res_array(args->avail_res_array);
+	args->avail_res_array = serial_args.avail_res_array;
+	for (i = 0; i < node_record_count; i++) {
+		FREE_NULL_BITMAP(args->core_map[i]);
+		args->core_map[i] = orig_core_map[i];
+	}
+	xfree(orig_core_map);
+}
+
 /*
  * Determine resource availability for pending job
  *
@@ -595,27 +757,41 @@ static avail_res_t **_get_res_avail(job_record_t *job_ptr,
 				    bool will_run, bitstr_t **part_core_map,
 				    resv_exc_t *resv_exc_ptr)
 {
-	int i, i_first, i_last;
-	avail_res_t **avail_res_array = NULL;
-	uint32_t s_p_n = _socks_per_node(job_ptr);
+	int i_first, i_last;
+	bitstr_t **orig_core_map = NULL;
+	res_avail_args_t args = {
+		.job_ptr = job_ptr,
+		.node_map = node_map,
+		.core_map = core_map,
+		.node_usage = node_usage,
+		.cr_type = cr_type,
+		.test_only = test_only,
+		.will_run = will_run,
+		.part_core_map = part_core_map,
+		.resv_exc_ptr = resv_exc_ptr,
+		.s_p_n = _socks_per_node(job_ptr),
+	};
 
-	avail_res_array = xcalloc(node_record_count, sizeof(avail_res_t *));
+	args.avail_res_array = xcalloc(node_record_count,
+				       sizeof(avail_res_t *));
 	i_first = bit_ffs(node_map);
 	if (i_first != -1)
 		i_last = bit_fls(node_map);
 	else
 		i_last = -2;
-	for (i = i_first; i <= i_last; i++) {
-		if (bit_test(node_map, i))
-			avail_res_array[i] =
-				_can_job_run_on_node(
-					job_ptr, core_map, i,
-					s_p_n, node_usage,
-					cr_type, test_only, will_run,
-					part_core_map, resv_exc_ptr);
+
+	if (!res_avail_workq || ((i_last - i_first) < (2 * RES_AVAIL_CHUNK))) {
+		_get_res_avail_range(&args, i_first, i_last);
+		return args.avail_res_array;
 	}
 
-	return avail_res_array;
+	if (select_eval_verify)
+		orig_core_map = copy_core_array(core_map);
+	_get_res_avail_parallel(&args, i_first, i_last);
+	if (orig_core_map)
+		_verify_res_avail(&args, orig_core_map, i_first, i_last);
+
+	return args.avail_res_array;
 }
 
 /* For a given job already past it's end time, guess when it will actually end.
@@ -665,6 +841,11 @@ static int _is_node_busy(part_res_record_t *p_ptr, uint32_t node_i,
 	uint16_t num_rows;
 	bitstr_t *use_row_bitmap = NULL;
 
+	/* Allocations in every row of every partition are cached */
+	if (!sharing_only && (p_ptr == select_part_record) &&
+	    (!preempt_by_qos || qos_preemptor))
+		return part_data_node_alloc_cores(node_i);
+
 	for (; p_ptr; p_ptr = p_ptr->next) {
 		num_rows = p_ptr->num_rows;
 		if (preempt_by_qos && !qos_preemptor)
@@ -693,11 +874,44 @@ static int _is_node_busy(part_res_record_t *p_ptr, uint32_t node_i,
 	return 0;
 }
 
-static bool _is_preemptable(job_record_t *job_ptr, List preemptee_candidates)
+static void _job_id_key(void *item, const char **key, uint32_t *key_len)
+{
+	job_record_t *job_ptr = item;
+
+	*key = (const char *) &job_ptr->job_id;
+	*key_len = sizeof(job_ptr->job_id);
+}
+
+static int _add_job_hash(void *x, void *arg)
+{
+	xhash_add(arg, x);
+
+	return 0;
+}
+
+/*
+ * Index preemptee_candidates by job ID so each running job can be checked
+ * against it without walking the whole list. Free with xhash_free().
+ */
+static xhash_t *_build_preemptee_hash(List preemptee_candidates)
 {
+	xhash_t *preemptee_hash;
+
 	if (!preemptee_candidates)
+		return NULL;
+
+	preemptee_hash = xhash_init(_job_id_key, NULL);
+	list_for_each(preemptee_candidates, _add_job_hash, preemptee_hash);
+
+	return preemptee_hash;
+}
+
+static bool _is_preemptable(job_record_t *job_ptr, xhash_t *preemptee_hash)
+{
+	if (!preemptee_hash)
 		return false;
-	if (list_find_first(preemptee_candidates, _find_job, job_ptr))
+	if (xhash_get(preemptee_hash, (char *) &job_ptr->job_id,
+		      sizeof(job_ptr->job_id)) == job_ptr)
 		return true;
 	return false;
 }
@@ -1273,6 +1487,8 @@ try_next_nodes_cnt:
 	}
 
 	/* remove all existing allocations from free_cores */
+	if (cr_part_ptr == select_part_record)
+		core_array_and_not(free_cores, part_data_get_alloc_cores());
 	for (p_ptr = cr_part_ptr; p_ptr; p_ptr = p_ptr->next) {
 		if (!p_ptr->row)
 			continue;
@@ -1280,8 +1496,9 @@ try_next_nodes_cnt:
 			if (!p_ptr->row[i].row_bitmap)
 				continue;
 
-			core_array_and_not(free_cores,
-					   p_ptr->row[i].row_bitmap);
+			if (cr_part_ptr != select_part_record)
+				core_array_and_not(free_cores,
+						   p_ptr->row[i].row_bitmap);
 			if (p_ptr->part_ptr != job_ptr->part_ptr)
 				continue;
 			if (part_core_map) {
@@ -2098,7 +2315,7 @@ static int _build_cr_job_list(void *x, void *arg)
 			return 0;
 		}
 	}
-	if (!_is_preemptable(job_ptr_preempt, args->preemptee_candidates)) {
+	if (!_is_preemptable(job_ptr_preempt, args->preemptee_hash)) {
 		/* Queue job for later removal from data structures */
 		list_append(args->cr_job_list, tmp_job_ptr);
 	} else if (tmp_job_ptr == job_ptr_preempt) {
@@ -2226,7 +2443,7 @@ static int _will_run_test(job_record_t *job_ptr, bitstr_t *node_bitmap,
 	/* Build list of running and suspended jobs */
 	cr_job_list = list_create(NULL);
 	args = (cr_job_list_args_t) {
-		.preemptee_candidates = preemptee_candidates,
+		.preemptee_hash = _build_preemptee_hash(preemptee_candidates),
 		.cr_job_list = cr_job_list,
 		.future_usage = future_usage,
 		.future_part = future_part,
@@ -2235,6 +2452,7 @@ static int _will_run_test(job_record_t *job_ptr, bitstr_t *node_bitmap,
 		.qos_preemptor = &qos_preemptor,
 	};
 	list_for_each(job_list, _build_cr_job_list, &args);
+	xhash_free(args.preemptee_hash);
 
 	/* Test with all preemptable jobs gone */
 	if (preemptee_candidates) {
@@ -3271,3 +3489,15 @@ extern int job_test(job_record_t *job_ptr, bitstr_t *node_bitmap,
 
 	return rc;
 }
+
+extern void job_test_init(void)
+{
+	job_test_fini();
+	if (select_eval_threads > 1)
+		res_avail_workq = new_workq(select_eval_threads - 1);
+}
+
+extern void job_test_fini(void)
+{
+	FREE_NULL_WORKQ(res_avail_workq);
+}
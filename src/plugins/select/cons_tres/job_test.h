@@ -43,6 +43,8 @@ extern uint64_t def_mem_per_gpu;
 extern bool preempt_strict_order;
 extern bool preempt_for_licenses;
 extern int preempt_reorder_cnt;
+extern int select_eval_threads;
+extern bool select_eval_verify;
 
 /*
  * job_test - Given a specification of scheduling requirements,
@@ -82,4 +84,13 @@ extern int job_test(job_record_t *job_ptr, bitstr_t *bitmap,
 		    List *preemptee_job_list,
 		    resv_exc_t *resv_exc_ptr);
 
+/*
+ * (Re)create the pool of threads used to evaluate nodes in parallel,
+ * sized by select_eval_threads
+ */
+extern void job_test_init(void);
+
+/* Stop the threads started by job_test_init() */
+extern void job_test_fini(void);
+
 #endif /* !_CONS_TRES_JOB_TEST_H */
@@ -41,6 +41,15 @@
 
 part_res_record_t *select_part_record = NULL;
 
+/*
+ * Cores allocated to jobs in any row of any partition of select_part_record,
+ * one bitmap per node. Entries are rebuilt on demand for nodes set in
+ * alloc_cores_stale, so scheduling many jobs in a row does not need to walk
+ * every partition row for every job.
+ */
+static bitstr_t **alloc_cores_cache = NULL;
+static bitstr_t *alloc_cores_stale = NULL;
+
 typedef struct {
 	int jstart;
 	struct job_resources *tmpjobs;
@@ -328,6 +337,7 @@ extern void part_data_create_array(void)
 
 	part_data_destroy_res(select_part_record);
 	select_part_record = NULL;
+	part_data_alloc_cores_fini();
 
 	num_parts = list_count(part_list);
 	if (!num_parts)
@@ -519,3 +529,67 @@ extern part_row_data_t *part_data_dup_row(part_row_data_t *orig_row,
 	}
 	return new_row;
 }
+
+extern bitstr_t **part_data_get_alloc_cores(void)
+{
+	part_res_record_t *p_ptr;
+	bitstr_t *row_bitmap;
+	int n, r;
+
+	if (!alloc_cores_cache) {
+		alloc_cores_cache = build_core_array();
+		alloc_cores_stale = bit_alloc(node_record_count);
+		bit_set_all(alloc_cores_stale);
+	}
+
+	for (n = bit_ffs(alloc_cores_stale); n >= 0;
+	     n = bit_ffs_from_bit(alloc_cores_stale, n + 1)) {
+		FREE_NULL_BITMAP(alloc_cores_cache[n]);
+		for (p_ptr = select_part_record; p_ptr; p_ptr = p_ptr->next) {
+			if (!p_ptr->row)
+				continue;
+			for (r = 0; r < p_ptr->num_rows; r++) {
+				if (!p_ptr->row[r].row_bitmap ||
+				    !(row_bitmap = p_ptr->row[r].row_bitmap[n]))
+					continue;
+				if (!alloc_cores_cache[n]) {
+					alloc_cores_cache[n] =
+						bit_copy(row_bitmap);
+					continue;
+				}
+				if (bit_size(alloc_cores_cache[n]) <
+				    bit_size(row_bitmap))
+					bit_realloc(alloc_cores_cache[n],
+						    bit_size(row_bitmap));
+				bit_or(alloc_cores_cache[n], row_bitmap);
+			}
+		}
+	}
+	bit_clear_all(alloc_cores_stale);
+
+	return alloc_cores_cache;
+}
+
+extern bool part_data_node_alloc_cores(int node_inx)
+{
+	bitstr_t **alloc_cores = part_data_get_alloc_cores();
+
+	return (alloc_cores[node_inx] &&
+		(bit_ffs(alloc_cores[node_inx]) != -1));
+}
+
+extern void part_data_alloc_cores_invalidate(bitstr_t *node_bitmap)
+{
+	if (!alloc_cores_stale)
+		return;
+	if (node_bitmap)
+		bit_or(alloc_cores_stale, node_bitmap);
+	else
+		bit_set_all(alloc_cores_stale);
+}
+
+extern void part_data_alloc_cores_fini(void)
+{
+	free_core_array(&alloc_cores_cache);
+	FREE_NULL_BITMAP(alloc_cores_stale);
+}
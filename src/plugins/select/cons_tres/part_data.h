@@ -103,5 +103,24 @@ extern void part_data_sort_res(part_res_record_t *p_ptr);
 extern part_row_data_t *part_data_dup_row(part_row_data_t *orig_row,
 					       uint16_t num_rows);
 
+/*
+ * Return the cores allocated to jobs in any row of any partition of
+ * select_part_record, one bitmap per node (NULL if none allocated). The
+ * array is cached and only rebuilt for nodes invalidated since the last
+ * call. Do not modify or free the returned array.
+ */
+extern bitstr_t **part_data_get_alloc_cores(void);
+
+/* Return true if any row of select_part_record has cores allocated on node */
+extern bool part_data_node_alloc_cores(int node_inx);
+
+/*
+ * Flag the nodes whose row_bitmaps in select_part_record have changed.
+ * IN node_bitmap - nodes to rebuild, NULL for all nodes
+ */
+extern void part_data_alloc_cores_invalidate(bitstr_t *node_bitmap);
+
+/* Free the cache built by part_data_get_alloc_cores() */
+extern void part_data_alloc_cores_fini(void);
 
 #endif /* _CONS_COMMON_PART_DATA_H */
@@ -223,6 +223,8 @@ extern int fini(void)
 	select_node_usage = NULL;
 	part_data_destroy_res(select_part_record);
 	select_part_record = NULL;
+	part_data_alloc_cores_fini();
+	job_test_fini();
 	cr_fini_global_core_data();
 
 	return SLURM_SUCCESS;
@@ -317,6 +319,23 @@ extern int select_p_node_init(void)
 	} else
 		bf_window_scale = 0;
 
+	select_eval_threads = 0;
+	if ((tmp_ptr = xstrcasestr(slurm_conf.sched_params,
+				   "select_eval_threads="))) {
+		select_eval_threads = atoi(tmp_ptr + 20);
+		if ((select_eval_threads < 0) ||
+		    (select_eval_threads > 256)) {
+			error("Invalid SchedulerParameters select_eval_threads: %d",
+			      select_eval_threads);
+			select_eval_threads = 0;	/* Use default value */
+		}
+	}
+	if (xstrcasestr(slurm_conf.sched_params, "select_eval_verify"))
+		select_eval_verify = true;
+	else
+		select_eval_verify = false;
+	job_test_init();
+
 	if (xstrcasestr(slurm_conf.sched_params, "spec_cores_first"))
 		spec_cores_first = true;
 	else
@@ -772,6 +791,7 @@ extern int select_p_job_resized(job_record_t *job_ptr, node_record_t *node_ptr)
 
 	/* some node of job removed from core-bitmap, so rebuild core bitmaps */
 	part_data_build_row_bitmaps(p_ptr, NULL);
+	part_data_alloc_cores_invalidate(NULL);
 
 	/*
 	 * Adjust the node_state of the node removed from this job.
@@ -550,6 +550,7 @@ extern int get_data(void)
 		jobs = slurmdb_jobcomp_jobs_get(job_cond);
 		return SLURM_SUCCESS;
 	} else {
+		job_cond->page_size = JOBS_PAGE_SIZE;
 		jobs = slurmdb_jobs_get(acct_db_conn, job_cond);
 	}
 
@@ -72,6 +72,7 @@
 #define LONG_COMP_FIELDS "jobid,uid,jobname,partition,nnodes,nodelist,state,start,end,timelimit"
 
 #define MAX_PRINTFIELDS 100
+#define JOBS_PAGE_SIZE 10000	/* jobs per reply from the slurmdbd */
 #define FORMAT_STRING_SIZE 34
 
 #define SECONDS_IN_MINUTE 60
@@ -324,6 +324,11 @@ extern int sacctmgr_list_stats(int argc, char **argv)
 		list_sort(stats_rec->user_list, (ListCmpF)_sort_rpc_obj_by_cnt);
 	}
 
+	printf("\nQuery cache\n");
+	printf("\tEntries:      %u\n", stats_rec->query_cache_entries);
+	printf("\tHits:         %"PRIu64"\n", stats_rec->query_cache_hits);
+	printf("\tMisses:       %"PRIu64"\n", stats_rec->query_cache_misses);
+
 	printf("\nRemote Procedure Call statistics by message type\n");
 	type = 0;
 	list_for_each(stats_rec->rpc_list, _print_rpc_obj, &type);
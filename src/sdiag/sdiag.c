@@ -125,7 +125,16 @@ static int _print_stats(void)
 	printf("Agent queue size:     %d\n", buf->agent_queue_size);
 	printf("Agent count:          %d\n", buf->agent_count);
 	printf("Agent thread count:   %d\n", buf->agent_thread_count);
-	printf("DBD Agent queue size: %d\n\n", buf->dbd_agent_queue_size);
+	printf("DBD Agent queue size: %d\n", buf->dbd_agent_queue_size);
+	printf("DBD Agent queue max:  %u\n", buf->dbd_agent_queue_max);
+	printf("DBD Agent discarded:  %u\n", buf->dbd_agent_discarded);
+	printf("DBD Agent batches:    %u\n", buf->dbd_agent_batches);
+	printf("DBD Agent latency:    last %u max %u",
+	       buf->dbd_agent_latency_last, buf->dbd_agent_latency_max);
+	if (buf->dbd_agent_batches > 0)
+		printf(" mean %"PRIu64,
+		       buf->dbd_agent_latency_sum / buf->dbd_agent_batches);
+	printf(" microseconds\n\n");
 
 	printf("Jobs submitted: %d\n", buf->jobs_submitted);
 	printf("Jobs started:   %d\n", buf->jobs_started);
@@ -154,6 +163,7 @@ static int _print_stats(void)
 		       ((buf->req_time - buf->req_time_start) / 60)));
 	}
 	printf("\tLast queue length: %u\n", buf->schedule_queue_len);
+	printf("\tJobs skipped by shape: %u\n", buf->schedule_shape_hits);
 
 	printf("\nMain scheduler exit:\n");
 
@@ -206,6 +216,7 @@ static int _print_stats(void)
 		printf("\tMean table size: %u\n",
 		       buf->bf_table_size_sum / buf->bf_cycle_counter);
 	}
+	printf("\tJobs skipped by shape: %u\n", buf->bf_shape_hits);
 	printf("\nBackfill exit\n");
 
 	for (i = 0; i < buf->bf_exit_cnt; i++) {
@@ -213,6 +224,21 @@ static int _print_stats(void)
 		       buf->bf_exit[i]);
 	}
 
+	/* Only priority/multifactor has a decay thread */
+	if (!xstrcmp(slurm_conf.priority_type, "priority/multifactor")) {
+		printf("\nPriority decay\n");
+		printf("\tTotal cycles: %u\n", buf->decay_cycle_counter);
+		printf("\tLast cycle: %u\n", buf->decay_cycle_last);
+		printf("\tMax cycle:  %u\n", buf->decay_cycle_max);
+		if (buf->decay_cycle_counter > 0) {
+			printf("\tMean cycle: %"PRIu64"\n",
+			       buf->decay_cycle_sum /
+			       buf->decay_cycle_counter);
+		}
+		printf("\tLast jobs calculated: %u\n", buf->decay_jobs_calc);
+		printf("\tLast jobs skipped: %u\n", buf->decay_jobs_skipped);
+	}
+
 	printf("\nLatency for 1000 calls to gettimeofday(): %d microseconds\n",
 	       buf->gettimeofday_latency);
 
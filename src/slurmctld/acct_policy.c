@@ -39,6 +39,7 @@
 #include "slurm/slurm_errno.h"
 
 #include "src/common/assoc_mgr.h"
+#include "src/common/xhash.h"
 
 #include "src/interfaces/accounting_storage.h"
 #include "src/interfaces/priority.h"
@@ -531,28 +532,46 @@ static int _get_tres_state_reason(int tres_pos, int unk_reason)
 	return unk_reason;
 }
 
-static int _find_used_limits_for_acct(void *x, void *key)
+static void _used_limits_acct_id(void *item, const char **key,
+				 uint32_t *key_len)
 {
-	slurmdb_used_limits_t *used_limits = (slurmdb_used_limits_t *)x;
-	char *account = (char *)key;
+	slurmdb_used_limits_t *used_limits = item;
 
-	if (!xstrcmp(account, used_limits->acct))
-		return 1;
-
-	return 0;
+	*key = used_limits->acct ? used_limits->acct : "";
+	*key_len = strlen(*key);
 }
 
-static int _find_used_limits_for_user(void *x, void *key)
+static void _used_limits_user_id(void *item, const char **key,
+				 uint32_t *key_len)
 {
-	slurmdb_used_limits_t *used_limits = (slurmdb_used_limits_t *)x;
-	uint32_t user_id = *(uint32_t *)key;
+	slurmdb_used_limits_t *used_limits = item;
+
+	*key = (const char *) &used_limits->uid;
+	*key_len = sizeof(used_limits->uid);
+}
 
-	if (used_limits->uid == user_id)
-		return 1;
+static int _add_used_limits_hash(void *x, void *arg)
+{
+	xhash_add(arg, x);
 
 	return 0;
 }
 
+/*
+ * Return the hash table indexing a used limit list, creating it from the
+ * list's current records if needed. The list owns the records.
+ */
+static xhash_t *_get_used_limits_hash(List limit_list, void **hash,
+				      xhash_idfunc_t idfunc)
+{
+	if (!*hash) {
+		*hash = xhash_init(idfunc, NULL);
+		list_for_each(limit_list, _add_used_limits_hash, *hash);
+	}
+
+	return *hash;
+}
+
 static bool _valid_job_assoc(job_record_t *job_ptr)
 {
 	slurmdb_assoc_rec_t assoc_rec;
@@ -592,11 +611,11 @@ static void _qos_adjust_limit_usage(int type, job_record_t *job_ptr,
 		return;
 
 	used_limits_a =	acct_policy_get_acct_used_limits(
-		&qos_ptr->usage->acct_limit_list,
+		qos_ptr->usage,
 		job_ptr->assoc_ptr->acct);
 
 	used_limits = acct_policy_get_user_used_limits(
-		&qos_ptr->usage->user_limit_list,
+		qos_ptr->usage,
 		job_ptr->user_id);
 
 	switch (type) {
@@ -1855,7 +1874,7 @@ static int _qos_policy_validate(job_desc_msg_t *job_desc,
 	    (qos_ptr->max_submit_jobs_pa != INFINITE)) {
 		slurmdb_used_limits_t *used_limits =
 			acct_policy_get_acct_used_limits(
-				&qos_ptr->usage->acct_limit_list,
+				qos_ptr->usage,
 				assoc_ptr->acct);
 
 		qos_out_ptr->max_submit_jobs_pa = qos_ptr->max_submit_jobs_pa;
@@ -1878,7 +1897,7 @@ static int _qos_policy_validate(job_desc_msg_t *job_desc,
 	    (qos_ptr->max_submit_jobs_pu != INFINITE)) {
 		slurmdb_used_limits_t *used_limits =
 			acct_policy_get_user_used_limits(
-				&qos_ptr->usage->user_limit_list,
+				qos_ptr->usage,
 				job_desc->user_id);
 
 		qos_out_ptr->max_submit_jobs_pu = qos_ptr->max_submit_jobs_pu;
@@ -1952,11 +1971,11 @@ static int _qos_job_runnable_pre_select(job_record_t *job_ptr,
 	wall_mins = qos_ptr->usage->grp_used_wall / 60;
 
 	used_limits_a =	acct_policy_get_acct_used_limits(
-		&qos_ptr->usage->acct_limit_list,
+		qos_ptr->usage,
 		assoc_ptr->acct);
 
 	used_limits = acct_policy_get_user_used_limits(
-		&qos_ptr->usage->user_limit_list,
+		qos_ptr->usage,
 		job_ptr->user_id);
 
 
@@ -2176,11 +2195,11 @@ static int _qos_job_runnable_post_select(job_record_t *job_ptr,
 	}
 
 	used_limits_a =	acct_policy_get_acct_used_limits(
-		&qos_ptr->usage->acct_limit_list,
+		qos_ptr->usage,
 		assoc_ptr->acct);
 
 	used_limits = acct_policy_get_user_used_limits(
-		&qos_ptr->usage->user_limit_list,
+		qos_ptr->usage,
 		job_ptr->user_id);
 
 	tres_usage = _validate_tres_usage_limits_for_qos(
@@ -4661,10 +4680,10 @@ extern int acct_policy_handle_accrue_time(job_record_t *job_ptr,
 	qos_ptr = job_ptr->qos_ptr;
 	if (qos_ptr) {
 		used_limits_acct = acct_policy_get_acct_used_limits(
-			&qos_ptr->usage->acct_limit_list,
+			qos_ptr->usage,
 			assoc_ptr->acct);
 		used_limits_user = acct_policy_get_user_used_limits(
-				&qos_ptr->usage->user_limit_list,
+				qos_ptr->usage,
 				job_ptr->user_id);
 	}
 
@@ -4775,10 +4794,10 @@ extern void acct_policy_add_accrue_time(job_record_t *job_ptr,
 	qos_ptr = job_ptr->qos_ptr;
 	if (qos_ptr) {
 		used_limits_acct = acct_policy_get_acct_used_limits(
-			&qos_ptr->usage->acct_limit_list,
+			qos_ptr->usage,
 			assoc_ptr->acct);
 		used_limits_user = acct_policy_get_user_used_limits(
-				&qos_ptr->usage->user_limit_list,
+				qos_ptr->usage,
 				job_ptr->user_id);
 	}
 
@@ -4833,10 +4852,10 @@ extern void acct_policy_remove_accrue_time(job_record_t *job_ptr,
 	qos_ptr = job_ptr->qos_ptr;
 	if (qos_ptr) {
 		used_limits_acct = acct_policy_get_acct_used_limits(
-			&qos_ptr->usage->acct_limit_list,
+			qos_ptr->usage,
 			assoc_ptr->acct);
 		used_limits_user = acct_policy_get_user_used_limits(
-				&qos_ptr->usage->user_limit_list,
+				qos_ptr->usage,
 				job_ptr->user_id);
 	}
 
@@ -4985,24 +5004,28 @@ extern void acct_policy_set_qos_order(job_record_t *job_ptr,
 }
 
 /*
- * Checks for record in *user_limit_list of user_id if
- * *user_limit_list doesn't exist it will create it, if the user_id
+ * Checks for record in usage->acct_limit_list of acct if
+ * usage->acct_limit_list doesn't exist it will create it, if the acct
  * record doesn't exist it will add it to the list.
- * In all cases the user record is returned.
+ * In all cases the acct record is returned.
  */
 extern slurmdb_used_limits_t *acct_policy_get_acct_used_limits(
-	List *acct_limit_list, char *acct)
+	slurmdb_qos_usage_t *usage, char *acct)
 {
 	slurmdb_used_limits_t *used_limits;
+	xhash_t *hash;
+
+	xassert(usage);
 
-	xassert(acct_limit_list);
+	if (!usage->acct_limit_list)
+		usage->acct_limit_list =
+			list_create(slurmdb_destroy_used_limits);
 
-	if (!*acct_limit_list)
-		*acct_limit_list = list_create(slurmdb_destroy_used_limits);
+	hash = _get_used_limits_hash(usage->acct_limit_list,
+				     &usage->acct_limit_hash,
+				     _used_limits_acct_id);
 
-	if (!(used_limits = list_find_first(*acct_limit_list,
-					    _find_used_limits_for_acct,
-					    acct))) {
+	if (!(used_limits = xhash_get_str(hash, acct ? acct : ""))) {
 		int i = sizeof(uint64_t) * slurmctld_tres_cnt;
 
 		used_limits = xmalloc(sizeof(slurmdb_used_limits_t));
@@ -5011,31 +5034,37 @@ extern slurmdb_used_limits_t *acct_policy_get_acct_used_limits(
 		used_limits->tres = xmalloc(i);
 		used_limits->tres_run_mins = xmalloc(i);
 
-		list_append(*acct_limit_list, used_limits);
+		list_append(usage->acct_limit_list, used_limits);
+		xhash_add(hash, used_limits);
 	}
 
 	return used_limits;
 }
 
 /*
- * Checks for record in *user_limit_list of user_id if
- * *user_limit_list doesn't exist it will create it, if the user_id
+ * Checks for record in usage->user_limit_list of user_id if
+ * usage->user_limit_list doesn't exist it will create it, if the user_id
  * record doesn't exist it will add it to the list.
  * In all cases the user record is returned.
  */
 extern slurmdb_used_limits_t *acct_policy_get_user_used_limits(
-	List *user_limit_list, uint32_t user_id)
+	slurmdb_qos_usage_t *usage, uint32_t user_id)
 {
 	slurmdb_used_limits_t *used_limits;
+	xhash_t *hash;
+
+	xassert(usage);
 
-	xassert(user_limit_list);
+	if (!usage->user_limit_list)
+		usage->user_limit_list =
+			list_create(slurmdb_destroy_used_limits);
 
-	if (!*user_limit_list)
-		*user_limit_list = list_create(slurmdb_destroy_used_limits);
+	hash = _get_used_limits_hash(usage->user_limit_list,
+				     &usage->user_limit_hash,
+				     _used_limits_user_id);
 
-	if (!(used_limits = list_find_first(*user_limit_list,
-					    _find_used_limits_for_user,
-					    &user_id))) {
+	if (!(used_limits = xhash_get(hash, (char *) &user_id,
+				      sizeof(user_id)))) {
 		int i = sizeof(uint64_t) * slurmctld_tres_cnt;
 
 		used_limits = xmalloc(sizeof(slurmdb_used_limits_t));
@@ -5044,7 +5073,8 @@ extern slurmdb_used_limits_t *acct_policy_get_user_used_limits(
 		used_limits->tres = xmalloc(i);
 		used_limits->tres_run_mins = xmalloc(i);
 
-		list_append(*user_limit_list, used_limits);
+		list_append(usage->user_limit_list, used_limits);
+		xhash_add(hash, used_limits);
 	}
 
 	return used_limits;
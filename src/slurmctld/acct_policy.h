@@ -209,9 +209,9 @@ extern void acct_policy_set_qos_order(job_record_t *job_ptr,
 				      slurmdb_qos_rec_t **qos_ptr_2);
 
 extern slurmdb_used_limits_t *acct_policy_get_acct_used_limits(
-	List *acct_limit_list, char *acct);
+	slurmdb_qos_usage_t *usage, char *acct);
 
 extern slurmdb_used_limits_t *acct_policy_get_user_used_limits(
-	 List *user_limit_list, uint32_t user_id);
+	slurmdb_qos_usage_t *usage, uint32_t user_id);
 
 #endif /* !_HAVE_ACCT_POLICY_H */
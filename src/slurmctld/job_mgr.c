@@ -2950,6 +2950,8 @@ static void _add_job_hash(job_record_t *job_ptr)
 	inx = JOB_HASH_INX(job_ptr->job_id);
 	job_ptr->job_next = job_hash[inx];
 	job_hash[inx] = job_ptr;
+
+	depend_job_list_changed();
 }
 
 /* _remove_job_hash - remove a job hash entry for given job record, job_id must
@@ -4585,6 +4587,7 @@ extern job_record_t *job_array_split(job_record_t *job_ptr)
 	details_new->cpu_freq_max = job_details->cpu_freq_max;
 	details_new->cpu_freq_gov = job_details->cpu_freq_gov;
 	details_new->depend_list = depended_list_copy(job_details->depend_list);
+	details_new->depend_tested = false;
 	details_new->dependency = xstrdup(job_details->dependency);
 	details_new->orig_dependency = xstrdup(job_details->orig_dependency);
 	if (job_details->env_cnt) {
@@ -9883,6 +9886,10 @@ static void _delete_job_common(job_record_t *job_ptr)
 	/* Remove record from fed_job_list */
 	fed_mgr_remove_fed_job_info(job_ptr->job_id);
 
+	/* Release jobs depending on this one, drop it from singleton index */
+	depend_job_state_changed(job_ptr);
+	depend_job_list_changed();
+
 	/* Remove the record from job hash table */
 	_remove_job_hash(job_ptr, JOB_HASH_JOB);
 
@@ -13702,6 +13709,7 @@ static int _update_job(job_record_t *job_ptr, job_desc_msg_t *job_desc,
 		} else {
 			xfree(job_ptr->name);
 			job_ptr->name = xstrdup(job_desc->name);
+			depend_job_list_changed();
 
 			sched_info("%s: setting name to %s for %pJ",
 				   __func__, job_ptr->name, job_ptr);
@@ -66,6 +66,7 @@
 #include "src/common/track_script.h"
 #include "src/common/uid.h"
 #include "src/common/xassert.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 
 #include "src/interfaces/accounting_storage.h"
@@ -135,6 +136,44 @@ static int sched_min_interval = 2;
 static int bb_array_stage_cnt = 10;
 extern diag_stats_t slurmctld_diag_stats;
 
+/* Identifies a job queue record across sort_job_queue() calls */
+typedef struct {
+	uint32_t job_id;
+	uint32_t array_task_id;
+	part_record_t *part_ptr;
+	slurmctld_resv_t *resv_ptr;
+	bool use_prefer;
+} queue_order_id_t;
+
+/* Everything sort_job_queue2() looks at without preemption or hetjob prio */
+typedef struct {
+	bool has_resv;
+	bool has_details;
+	uint32_t priority_tier;
+	uint32_t priority;
+	time_t submit_time;
+	uint32_t sort_job_id;
+	time_t resv_start_time;
+} queue_order_key_t;
+
+typedef struct {
+	queue_order_id_t id;	/* hash key, must be zeroed incl. padding */
+	queue_order_key_t key;	/* must be zeroed incl. padding */
+	uint32_t pos;		/* position in the last sorted queue */
+	job_queue_rec_t *rec;	/* only valid during sort_job_queue() */
+} queue_order_t;
+
+/*
+ * Order of the job queue from the last sort_job_queue() call. Records whose
+ * sort key did not change since then keep their relative order, so only the
+ * records that changed (new jobs, priority recalculation, etc.) need to be
+ * sorted and merged back into the queue.
+ */
+static pthread_mutex_t queue_order_mutex = PTHREAD_MUTEX_INITIALIZER;
+static xhash_t *queue_order_hash = NULL;
+static queue_order_t *queue_order = NULL;
+static uint32_t queue_order_cnt = 0;
+
 typedef struct {
 	part_record_t *part_ptr;
 	bool cleared;
@@ -171,6 +210,206 @@ static int _find_singleton_job (void *x, void *key)
 	return 0;
 }
 
+/*
+ * Reverse dependency edges: for each depended upon job id, the ids of the
+ * jobs whose cached test_job_dependency() result must be discarded once that
+ * job changes state. Each entry is consumed when it fires, dependents that
+ * still wait register again on their next full test.
+ */
+typedef struct {
+	uint32_t job_id;
+	List dependents;	/* uint32_t job ids */
+} depend_wake_t;
+
+static xhash_t *depend_wake_hash = NULL;
+
+/* Jobs in job_list grouped by user and name, for singleton dependencies */
+typedef struct {
+	char *key;
+	List jobs;		/* job_record_t, not owned */
+} singleton_rec_t;
+
+static xhash_t *singleton_hash = NULL;
+static bool singleton_hash_valid = false;
+
+static void _depend_wake_id(void *item, const char **key, uint32_t *key_len)
+{
+	depend_wake_t *wake = item;
+
+	*key = (char *) &wake->job_id;
+	*key_len = sizeof(wake->job_id);
+}
+
+static void _depend_wake_free(void *item)
+{
+	depend_wake_t *wake = item;
+
+	FREE_NULL_LIST(wake->dependents);
+	xfree(wake);
+}
+
+static void _depend_wake_add(uint32_t depend_job_id, uint32_t job_id)
+{
+	depend_wake_t *wake;
+	uint32_t *dependent;
+
+	if (!depend_wake_hash)
+		depend_wake_hash = xhash_init(_depend_wake_id,
+					      _depend_wake_free);
+
+	if (!(wake = xhash_get(depend_wake_hash, (char *) &depend_job_id,
+			       sizeof(depend_job_id)))) {
+		wake = xmalloc(sizeof(*wake));
+		wake->job_id = depend_job_id;
+		wake->dependents = list_create(xfree_ptr);
+		xhash_add(depend_wake_hash, wake);
+	}
+
+	dependent = xmalloc(sizeof(*dependent));
+	*dependent = job_id;
+	list_append(wake->dependents, dependent);
+}
+
+static int _clear_wake_set(void *x, void *arg)
+{
+	depend_spec_t *dep_ptr = x;
+	uint32_t *depend_job_id = arg;
+
+	if (dep_ptr->job_id == *depend_job_id)
+		dep_ptr->wake_set = false;
+
+	return 0;
+}
+
+static int _wake_dependent(void *x, void *arg)
+{
+	uint32_t *job_id = x;
+	job_record_t *job_ptr = find_job_record(*job_id);
+
+	if (!job_ptr || !job_ptr->details)
+		return 0;
+
+	job_ptr->details->depend_tested = false;
+	if (job_ptr->details->depend_list)
+		list_for_each(job_ptr->details->depend_list, _clear_wake_set,
+			      arg);
+
+	return 0;
+}
+
+static void _depend_wake(uint32_t depend_job_id)
+{
+	depend_wake_t *wake;
+
+	if (!(wake = xhash_get(depend_wake_hash, (char *) &depend_job_id,
+			       sizeof(depend_job_id))))
+		return;
+
+	list_for_each(wake->dependents, _wake_dependent, &depend_job_id);
+	xhash_delete(depend_wake_hash, (char *) &depend_job_id,
+		     sizeof(depend_job_id));
+}
+
+extern void depend_job_state_changed(job_record_t *job_ptr)
+{
+	if (!depend_wake_hash || !xhash_count(depend_wake_hash))
+		return;
+
+	_depend_wake(job_ptr->job_id);
+	if (job_ptr->array_job_id && (job_ptr->array_job_id != job_ptr->job_id))
+		_depend_wake(job_ptr->array_job_id);
+}
+
+extern void depend_job_list_changed(void)
+{
+	singleton_hash_valid = false;
+}
+
+static void _singleton_id(void *item, const char **key, uint32_t *key_len)
+{
+	singleton_rec_t *rec = item;
+
+	*key = rec->key;
+	*key_len = strlen(rec->key);
+}
+
+static void _singleton_free(void *item)
+{
+	singleton_rec_t *rec = item;
+
+	xfree(rec->key);
+	FREE_NULL_LIST(rec->jobs);
+	xfree(rec);
+}
+
+/*
+ * Jobs without a name match every singleton of the same user in
+ * _find_singleton_job(), so they get a key of their own.
+ */
+static char *_singleton_key(uint32_t user_id, char *name)
+{
+	if (!name)
+		return xstrdup_printf("%u", user_id);
+	return xstrdup_printf("%u:%s", user_id, name);
+}
+
+static int _singleton_hash_add(void *x, void *arg)
+{
+	job_record_t *job_ptr = x;
+	singleton_rec_t *rec;
+	char *key = _singleton_key(job_ptr->user_id, job_ptr->name);
+
+	if ((rec = xhash_get_str(singleton_hash, key))) {
+		xfree(key);
+	} else {
+		rec = xmalloc(sizeof(*rec));
+		rec->key = key;
+		rec->jobs = list_create(NULL);
+		xhash_add(singleton_hash, rec);
+	}
+	list_append(rec->jobs, job_ptr);
+
+	return 0;
+}
+
+/*
+ * Return a job blocking job_ptr's singleton dependency, NULL if none.
+ * Same as list_find_first(job_list, _find_singleton_job, job_ptr), but only
+ * looks at the jobs of the same user and name.
+ */
+static job_record_t *_find_singleton(job_record_t *job_ptr)
+{
+	singleton_rec_t *rec;
+	job_record_t *found = NULL;
+	char *key;
+
+	if (!singleton_hash_valid) {
+		if (singleton_hash)
+			xhash_clear(singleton_hash);
+		else
+			singleton_hash = xhash_init(_singleton_id,
+						    _singleton_free);
+		list_for_each(job_list, _singleton_hash_add, NULL);
+		singleton_hash_valid = true;
+	}
+
+	key = _singleton_key(job_ptr->user_id, job_ptr->name);
+	if ((rec = xhash_get_str(singleton_hash, key)))
+		found = list_find_first(rec->jobs, _find_singleton_job,
+					job_ptr);
+	xfree(key);
+	if (found || !job_ptr->name)
+		return found;
+
+	key = _singleton_key(job_ptr->user_id, NULL);
+	if ((rec = xhash_get_str(singleton_hash, key)))
+		found = list_find_first(rec->jobs, _find_singleton_job,
+					job_ptr);
+	xfree(key);
+
+	return found;
+}
+
 /*
  * Calculate how busy the system is by figuring out how busy each node is.
  */
@@ -980,6 +1219,112 @@ extern void job_queue_append_internal(job_queue_req_t *job_queue_req)
 	list_append(job_queue_req->job_queue, job_queue_rec);
 }
 
+static void _job_shape_id(void *item, const char **key, uint32_t *key_len)
+{
+	job_shape_t *shape = item;
+
+	*key = shape->sig;
+	*key_len = strlen(shape->sig);
+}
+
+static void _job_shape_free(void *item)
+{
+	job_shape_t *shape = item;
+
+	xfree(shape->sig);
+	xfree(shape);
+}
+
+extern xhash_t *job_shape_cache_init(void)
+{
+	return xhash_init(_job_shape_id, _job_shape_free);
+}
+
+extern void job_shape_cache_add(xhash_t *cache, char *sig,
+				uint32_t state_reason, time_t start_time)
+{
+	job_shape_t *shape = xmalloc(sizeof(*shape));
+
+	shape->sig = sig;
+	shape->state_reason = state_reason;
+	shape->start_time = start_time;
+	xhash_add(cache, shape);
+}
+
+/* Separator between fields which are free form strings */
+#define SHAPE_SEP "\037"
+
+/* Job flags which change how select plugins place the job */
+#define SHAPE_BIT_FLAGS (GRES_ENFORCE_BIND | SPREAD_JOB | USE_MIN_NODES | \
+			 JOB_NTASKS_SET | JOB_CPUS_SET | GRES_DISABLE_BIND | \
+			 JOB_MEM_SET | JOB_MAGNETIC | \
+			 GRES_ONE_TASK_PER_SHARING | \
+			 GRES_MULT_TASKS_PER_SHARING | \
+			 GRES_ALLOW_TASK_SHARING)
+
+extern char *job_shape_sig(job_record_t *job_ptr, bool use_prefer)
+{
+	job_details_t *details = job_ptr->details;
+	multi_core_data_t *mc_ptr;
+	char *sig = NULL;
+
+	/*
+	 * Jobs requesting switches are placed depending on how long each one
+	 * has waited for them (wait4switch_start), never share their answer.
+	 */
+	if (!details || job_ptr->het_job_id || job_ptr->burst_buffer ||
+	    job_ptr->resv_list || job_ptr->req_switch ||
+	    details->arbitrary_tpn ||
+	    details->req_node_bitmap || details->job_size_bitmap ||
+	    details->expanding_jobid ||
+	    (job_ptr->deadline && (job_ptr->deadline != NO_VAL)))
+		return NULL;
+
+	xstrfmtcat(sig, "%p|%p|%u|%u|%u|%u|%u|%u|%u|%"PRIx64,
+		   job_ptr->part_ptr, job_ptr->resv_ptr, job_ptr->qos_id,
+		   job_ptr->assoc_id, job_ptr->user_id, job_ptr->group_id,
+		   job_ptr->time_limit, job_ptr->time_min, job_ptr->reboot,
+		   (job_ptr->bit_flags & SHAPE_BIT_FLAGS));
+
+	/* Lower priority jobs may have fewer jobs they can preempt */
+	if (slurm_preemption_enabled())
+		xstrfmtcat(sig, "|%u", job_ptr->priority);
+
+	xstrfmtcat(sig, "|%u|%u|%u|%u|%u|%u|%u|%u|%u|%"PRIu64"|%u|%u|%u|%u|%u|%u|%u|%u",
+		   details->min_cpus, details->max_cpus, details->min_nodes,
+		   details->max_nodes, details->num_tasks,
+		   details->ntasks_per_node, details->ntasks_per_tres,
+		   details->cpus_per_task, details->pn_min_cpus,
+		   details->pn_min_memory, details->pn_min_tmp_disk,
+		   details->contiguous, details->core_spec,
+		   details->share_res, details->whole_node,
+		   details->overcommit, details->task_dist,
+		   details->plane_size);
+
+	if ((mc_ptr = details->mc_ptr))
+		xstrfmtcat(sig, "|%u|%u|%u|%u|%u|%u|%u|%u",
+			   mc_ptr->boards_per_node, mc_ptr->sockets_per_board,
+			   mc_ptr->sockets_per_node, mc_ptr->cores_per_socket,
+			   mc_ptr->threads_per_core, mc_ptr->ntasks_per_board,
+			   mc_ptr->ntasks_per_socket, mc_ptr->ntasks_per_core);
+
+	xstrfmtcat(sig, SHAPE_SEP "%s" SHAPE_SEP "%s" SHAPE_SEP "%s"
+		   SHAPE_SEP "%s" SHAPE_SEP "%s" SHAPE_SEP "%s" SHAPE_SEP "%s"
+		   SHAPE_SEP "%s" SHAPE_SEP "%s" SHAPE_SEP "%s" SHAPE_SEP "%s"
+		   SHAPE_SEP "%s" SHAPE_SEP "%s" SHAPE_SEP "%s" SHAPE_SEP "%s"
+		   SHAPE_SEP "%s",
+		   (use_prefer ? details->prefer : details->features),
+		   details->exc_nodes, details->cluster_features,
+		   job_ptr->batch_features, job_ptr->licenses,
+		   job_ptr->mcs_label, job_ptr->network, job_ptr->extra,
+		   job_ptr->tres_per_job, job_ptr->tres_per_node,
+		   job_ptr->tres_per_socket, job_ptr->tres_per_task,
+		   job_ptr->cpus_per_tres, job_ptr->mem_per_tres,
+		   job_ptr->tres_bind, job_ptr->tres_freq);
+
+	return sig;
+}
+
 static void _set_features(job_record_t *job_ptr, bool use_prefer)
 {
 	/*
@@ -1020,6 +1365,9 @@ static int _schedule(bool full_queue)
 	part_record_t *part_ptr, *skip_part_ptr = NULL;
 	_failed_part_t *failed_parts = NULL;
 	slurmctld_resv_t **failed_resv = NULL;
+	xhash_t *failed_shapes = NULL;
+	job_shape_t *failed_shape;
+	char *shape_sig;
 	bitstr_t *save_avail_node_bitmap;
 	part_record_t **sched_part_ptr = NULL;
 	int *sched_part_jobs = NULL, bb_wait_cnt = 0;
@@ -1322,6 +1670,7 @@ static int _schedule(bool full_queue)
 	part_cnt = list_count(part_list);
 	failed_parts = xcalloc(part_cnt, sizeof(*failed_parts));
 	failed_resv = xcalloc(MAX_FAILED_RESV, sizeof(slurmctld_resv_t *));
+	failed_shapes = job_shape_cache_init();
 	save_avail_node_bitmap = bit_copy(avail_node_bitmap);
 	bit_or(avail_node_bitmap, rs_node_bitmap);
 
@@ -1770,8 +2119,29 @@ next_task:
 			job_ptr->time_limit = deadline_time_limit;
 		}
 
+		/*
+		 * Resources are only consumed during this cycle, so a job
+		 * identical to one that did not fit already will not fit
+		 * either. Handle it as if select_nodes() said so.
+		 */
+		shape_sig = job_shape_sig(job_ptr, use_prefer);
+		if (shape_sig &&
+		    (failed_shape = xhash_get_str(failed_shapes, shape_sig))) {
+			xfree(shape_sig);
+			slurmctld_diag_stats.schedule_shape_hits++;
+			if (job_ptr->state_reason != failed_shape->state_reason) {
+				job_ptr->state_reason =
+					failed_shape->state_reason;
+				xfree(job_ptr->state_desc);
+				last_job_update = now;
+			}
+			error_code = ESLURM_NODES_BUSY;
+			goto skip_start;
+		}
+
 		/* get fed job lock from origin cluster */
 		if (fed_mgr_job_lock(job_ptr)) {
+			xfree(shape_sig);
 			error_code = ESLURM_FED_JOB_LOCK;
 			goto skip_start;
 		}
@@ -1779,6 +2149,13 @@ next_task:
 		error_code = select_nodes(job_ptr, false, NULL, NULL, false,
 					  SLURMDB_JOB_FLAG_SCHED);
 
+		if ((error_code == ESLURM_NODES_BUSY) && shape_sig) {
+			job_shape_cache_add(failed_shapes, shape_sig,
+					    job_ptr->state_reason, 0);
+			shape_sig = NULL;
+		}
+		xfree(shape_sig);
+
 		if (error_code == SLURM_SUCCESS) {
 			/*
 			 * If the following fails because of network
@@ -2015,6 +2392,7 @@ fail_this_part:	if (fail_by_part) {
 	avail_node_bitmap = save_avail_node_bitmap;
 	xfree(failed_parts);
 	xfree(failed_resv);
+	xhash_free(failed_shapes);
 	if (fifo_sched) {
 		if (job_iterator)
 			list_iterator_destroy(job_iterator);
@@ -2041,13 +2419,149 @@ out:
 	return job_cnt;
 }
 
+static void _queue_order_identify(void *item, const char **key,
+				  uint32_t *key_len)
+{
+	queue_order_t *ent = item;
+
+	*key = (const char *) &ent->id;
+	*key_len = sizeof(ent->id);
+}
+
+static void _queue_order_clear(void)
+{
+	if (queue_order_hash)
+		xhash_clear(queue_order_hash);
+	xfree(queue_order);
+	queue_order_cnt = 0;
+}
+
+/* Fill in the id and sort key of a job queue record, see sort_job_queue2() */
+static void _queue_order_set(queue_order_t *ent, job_queue_rec_t *rec)
+{
+	job_record_t *job_ptr = rec->job_ptr;
+
+	memset(ent, 0, sizeof(*ent));
+	ent->rec = rec;
+
+	ent->id.job_id = rec->job_id;
+	ent->id.array_task_id = rec->array_task_id;
+	ent->id.part_ptr = rec->part_ptr;
+	ent->id.resv_ptr = rec->resv_ptr;
+	ent->id.use_prefer = rec->use_prefer;
+
+	ent->key.has_resv = (job_ptr->resv_id != 0) || rec->resv_ptr;
+	if (rec->part_ptr)
+		ent->key.priority_tier = rec->part_ptr->priority_tier;
+	if (job_ptr->part_ptr_list && job_ptr->priority_array)
+		ent->key.priority = rec->priority;
+	else
+		ent->key.priority = job_ptr->priority;
+	if (job_ptr->details) {
+		ent->key.has_details = true;
+		ent->key.submit_time = job_ptr->details->submit_time;
+	}
+	if (rec->array_task_id == NO_VAL)
+		ent->key.sort_job_id = rec->job_id;
+	else
+		ent->key.sort_job_id = job_ptr->array_job_id;
+	if (rec->resv_ptr)
+		ent->key.resv_start_time = rec->resv_ptr->start_time;
+}
+
+static int _sort_queue_order(const void *x, const void *y)
+{
+	queue_order_t *ent1 = *(queue_order_t **) x;
+	queue_order_t *ent2 = *(queue_order_t **) y;
+
+	return sort_job_queue2(&ent1->rec, &ent2->rec);
+}
+
+/*
+ * Sort the job queue reusing the order of the last call. Only valid if
+ * sort_job_queue2() depends on nothing but the queue_order_key_t of each
+ * record, so not with preemption or bf_hetjob_prio.
+ */
+static void _sort_job_queue_incr(List job_queue)
+{
+	queue_order_t *ents, *old;
+	queue_order_t **kept, **changed;
+	job_queue_rec_t *rec;
+	uint32_t cnt, changed_cnt = 0, i = 0, k = 0, c = 0, pos = 0;
+
+	cnt = list_count(job_queue);
+	ents = xcalloc(cnt, sizeof(*ents));
+	kept = xcalloc(queue_order_cnt + 1, sizeof(*kept));
+	changed = xcalloc(cnt, sizeof(*changed));
+
+	while ((i < cnt) && (rec = list_pop(job_queue))) {
+		queue_order_t *ent = &ents[i++];
+
+		_queue_order_set(ent, rec);
+		old = xhash_get(queue_order_hash, (char *) &ent->id,
+				sizeof(ent->id));
+		if (old && !kept[old->pos] &&
+		    !memcmp(&old->key, &ent->key, sizeof(ent->key)))
+			kept[old->pos] = ent;
+		else
+			changed[changed_cnt++] = ent;
+	}
+
+	if (changed_cnt > 1)
+		qsort(changed, changed_cnt, sizeof(*changed),
+		      _sort_queue_order);
+
+	/* Merge the records kept in their last order with the changed ones */
+	while ((k < queue_order_cnt) || (c < changed_cnt)) {
+		queue_order_t *ent;
+
+		if ((k < queue_order_cnt) && !kept[k]) {
+			k++;
+			continue;
+		}
+		if (k >= queue_order_cnt)
+			ent = changed[c++];
+		else if ((c >= changed_cnt) ||
+			 (_sort_queue_order(&kept[k], &changed[c]) <= 0))
+			ent = kept[k++];
+		else
+			ent = changed[c++];
+
+		ent->pos = pos++;
+		list_append(job_queue, ent->rec);
+		ent->rec = NULL;
+	}
+
+	sched_debug3("%s: %u of %u job queue records re-sorted",
+		     __func__, changed_cnt, cnt);
+
+	_queue_order_clear();
+	queue_order = ents;
+	queue_order_cnt = cnt;
+	for (i = 0; i < cnt; i++)
+		xhash_add(queue_order_hash, &queue_order[i]);
+
+	xfree(kept);
+	xfree(changed);
+}
+
 /*
  * sort_job_queue - sort job_queue in descending priority order
  * IN/OUT job_queue - sorted job queue
  */
 extern void sort_job_queue(List job_queue)
 {
-	list_sort(job_queue, sort_job_queue2);
+	slurm_mutex_lock(&queue_order_mutex);
+	if (slurm_preemption_enabled() || bf_hetjob_prio) {
+		_queue_order_clear();
+		list_sort(job_queue, sort_job_queue2);
+	} else {
+		if (!queue_order_hash)
+			queue_order_hash = xhash_init(_queue_order_identify,
+						      NULL);
+		_sort_job_queue_incr(job_queue);
+	}
+	slurm_mutex_unlock(&queue_order_mutex);
 }
 
 /* Note this differs from the ListCmpF typedef since we want jobs sorted
@@ -2752,6 +3266,7 @@ extern List depended_list_copy(List depend_list_src)
 	while ((dep_src = list_next(iter))) {
 		dep_dest = xmalloc(sizeof(depend_spec_t));
 		memcpy(dep_dest, dep_src, sizeof(depend_spec_t));
+		dep_dest->wake_set = false;
 		list_append(depend_list_dest, dep_dest);
 	}
 	list_iterator_destroy(iter);
@@ -3025,6 +3540,8 @@ extern int test_job_dependency(job_record_t *job_ptr, bool *was_changed)
 	bool is_complete, is_completed, is_pending;
 	bool or_satisfied = false, and_failed = false, or_flag = false,
 	     has_unfulfilled = false, changed = false;
+	/* Result can change without a depended job changing state */
+	bool must_poll = (fed_mgr_fed_rec != NULL);
 
 	if ((job_ptr->details == NULL) ||
 	    (job_ptr->details->depend_list == NULL) ||
@@ -3035,6 +3552,18 @@ extern int test_job_dependency(job_record_t *job_ptr, bool *was_changed)
 		return NO_DEPEND;
 	}
 
+	/*
+	 * Nothing this job waits on changed state since the last test, see
+	 * depend_job_state_changed().
+	 */
+	if (job_ptr->details->depend_tested) {
+		job_ptr->bit_flags |= JOB_DEPENDENT;
+		acct_policy_remove_accrue_time(job_ptr, false);
+		if (was_changed)
+			*was_changed = false;
+		return job_ptr->details->depend_rc;
+	}
+
 	depend_iter = list_iterator_create(job_ptr->details->depend_list);
 	while ((dep_ptr = list_next(depend_iter))) {
 		bool clear_dep = false, failure = false;
@@ -3061,6 +3590,8 @@ extern int test_job_dependency(job_record_t *job_ptr, bool *was_changed)
 			}
 		}
 		if ((dep_ptr->depend_state != DEPEND_NOT_FULFILLED) || remote) {
+			if (remote)
+				must_poll = true;
 			_test_dependency_state(dep_ptr, &or_satisfied,
 					       &and_failed, &or_flag,
 					       &has_unfulfilled);
@@ -3074,8 +3605,8 @@ extern int test_job_dependency(job_record_t *job_ptr, bool *was_changed)
 		djob_ptr = dep_ptr->job_ptr;
 		if ((dep_ptr->depend_type == SLURM_DEPEND_SINGLETON) &&
 		    job_ptr->name) {
-			if (list_find_first(job_list, _find_singleton_job,
-					    job_ptr) ||
+			must_poll = true;
+			if (_find_singleton(job_ptr) ||
 			    !fed_mgr_is_singleton_satisfied(job_ptr,
 							    dep_ptr, true)) {
 				/* Still depends */
@@ -3108,6 +3639,20 @@ extern int test_job_dependency(job_record_t *job_ptr, bool *was_changed)
 				    &clear_dep, &failure,
 				    job_ptr, dep_ptr))
 				failure = true;
+
+			/* These also depend on time or burst buffer state */
+			if ((dep_ptr->depend_time &&
+			     (dep_ptr->depend_type == SLURM_DEPEND_AFTER)) ||
+			    (dep_ptr->depend_type ==
+			     SLURM_DEPEND_BURST_BUFFER) ||
+			    (dep_ptr->depend_type == SLURM_DEPEND_EXPAND))
+				must_poll = true;
+			else if (!failure && !clear_dep &&
+				 !dep_ptr->wake_set) {
+				_depend_wake_add(dep_ptr->job_id,
+						 job_ptr->job_id);
+				dep_ptr->wake_set = true;
+			}
 		}
 
 		if (failure) {
@@ -3168,6 +3713,12 @@ extern int test_job_dependency(job_record_t *job_ptr, bool *was_changed)
 				REMOTE_DEPEND;
 	}
 
+	if (!must_poll &&
+	    ((results == LOCAL_DEPEND) || (results == FAIL_DEPEND))) {
+		job_ptr->details->depend_rc = results;
+		job_ptr->details->depend_tested = true;
+	}
+
 	if (was_changed)
 		*was_changed = changed;
 	return results;
@@ -3689,6 +4240,8 @@ extern bool update_job_dependency_list(job_record_t *job_ptr,
 		was_changed = true;
 	}
 	list_iterator_destroy(itr);
+	if (was_changed)
+		job_ptr->details->depend_tested = false;
 	return was_changed;
 }
 
@@ -3907,6 +4460,7 @@ extern int update_job_dependency(job_record_t *job_ptr, char *new_depend)
 	if (rc == SLURM_SUCCESS) {
 		FREE_NULL_LIST(job_ptr->details->depend_list);
 		job_ptr->details->depend_list = new_depend_list;
+		job_ptr->details->depend_tested = false;
 		_depend_list2str(job_ptr, or_flag);
 		if (slurm_conf.debug_flags & DEBUG_FLAG_DEPENDENCY)
 			print_job_dependency(job_ptr, __func__);
@@ -5274,4 +5828,12 @@ void main_sched_fini(void)
 	slurm_cond_broadcast(&sched_cond);
 	slurm_mutex_unlock(&sched_mutex);
 	slurm_thread_join(thread_id_sched);
+
+	slurm_mutex_lock(&queue_order_mutex);
+	_queue_order_clear();
+	xhash_free(queue_order_hash);
+	slurm_mutex_unlock(&queue_order_mutex);
+
+	xhash_free(depend_wake_hash);
+	xhash_free(singleton_hash);
 }
@@ -42,8 +42,17 @@
 #ifndef _JOB_SCHEDULER_H
 #define _JOB_SCHEDULER_H
 
+#include "src/common/xhash.h"
 #include "src/slurmctld/slurmctld.h"
 
+/* Entry of a per scheduling cycle cache of job shapes, see job_shape_sig() */
+typedef struct {
+	char *sig;
+	uint32_t state_reason;	/* reason given to the first job tested */
+	time_t start_time;	/* expected start of the first job tested,
+				 * 0 if unknown */
+} job_shape_t;
+
 typedef struct job_queue_rec {
 	uint32_t array_task_id;		/* Job array, task ID */
 	uint32_t job_id;		/* Job ID */
@@ -113,6 +122,19 @@ extern batch_job_launch_msg_t *build_launch_job_msg(job_record_t *job_ptr,
  */
 extern bool deadline_ok(job_record_t *job_ptr, const char *func);
 
+/*
+ * Note that a job was added to, removed from or renamed in job_list so the
+ * singleton dependency index gets rebuilt on its next use.
+ */
+extern void depend_job_list_changed(void);
+
+/*
+ * Wake jobs waiting on job_ptr's dependencies so their next
+ * test_job_dependency() call re-evaluates them. Call whenever job_ptr changes
+ * state or is purged. Requires job write lock.
+ */
+extern void depend_job_state_changed(job_record_t *job_ptr);
+
 /*
  * epilog_slurmctld - execute the prolog_slurmctld for a job that has just
  *	terminated.
@@ -157,6 +179,33 @@ extern int handle_job_dependency_updates(void *object, void *arg);
  */
 extern bool job_is_completing(bitstr_t *eff_cg_bitmap);
 
+/*
+ * job_shape_sig - Build a signature of everything that decides where a
+ *	pending job can be placed. Jobs with the same signature get the same
+ *	answer from select_nodes() as long as resources are only consumed, as
+ *	is the case within a scheduling cycle which does not release its locks.
+ * IN job_ptr - job to build the signature of
+ * IN use_prefer - the job is being tested with its prefer constraint
+ * RET xmalloc'd signature or NULL if the job must always be tested by itself
+ */
+extern char *job_shape_sig(job_record_t *job_ptr, bool use_prefer);
+
+/*
+ * job_shape_cache_init - Create a cache of job shapes which failed to start
+ *	in a scheduling cycle. Free with xhash_free().
+ */
+extern xhash_t *job_shape_cache_init(void);
+
+/*
+ * job_shape_cache_add - Add a failed job shape to the cache
+ * IN cache - created by job_shape_cache_init()
+ * IN sig - from job_shape_sig(), consumed by the cache
+ * IN state_reason - pending reason of the job that failed
+ * IN start_time - expected start time of the job that failed, 0 if unknown
+ */
+extern void job_shape_cache_add(xhash_t *cache, char *sig,
+				uint32_t state_reason, time_t start_time);
+
 /*
  * Determine if a pending job will run using only the specified nodes, build
  * response message and return SLURM_SUCCESS on success. Otherwise return an
@@ -36,6 +36,7 @@
 
 #include "src/common/macros.h"
 
+#include "src/slurmctld/job_scheduler.h"
 #include "src/slurmctld/slurmctld.h"
 
 #ifndef NDEBUG
@@ -116,7 +117,10 @@ extern void job_state_set(job_record_t *job_ptr, uint32_t state)
 	_check_job_state(state);
 	_log_job_state_change(job_ptr, state);
 
-	job_ptr->job_state = state;
+	if (job_ptr->job_state != state) {
+		job_ptr->job_state = state;
+		depend_job_state_changed(job_ptr);
+	}
 }
 
 extern void job_state_set_flag(job_record_t *job_ptr, uint32_t flag)
@@ -130,7 +134,10 @@ extern void job_state_set_flag(job_record_t *job_ptr, uint32_t flag)
 	_check_job_state(job_state);
 	_log_job_state_change(job_ptr, job_state);
 
-	job_ptr->job_state = job_state;
+	if (job_ptr->job_state != job_state) {
+		job_ptr->job_state = job_state;
+		depend_job_state_changed(job_ptr);
+	}
 }
 
 extern void job_state_unset_flag(job_record_t *job_ptr, uint32_t flag)
@@ -144,5 +151,8 @@ extern void job_state_unset_flag(job_record_t *job_ptr, uint32_t flag)
 	_check_job_state(job_state);
 	_log_job_state_change(job_ptr, job_state);
 
-	job_ptr->job_state = job_state;
+	if (job_ptr->job_state != job_state) {
+		job_ptr->job_state = job_state;
+		depend_job_state_changed(job_ptr);
+	}
 }
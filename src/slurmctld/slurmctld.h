@@ -187,6 +187,7 @@ typedef struct diag_stats {
 	uint32_t schedule_cycle_depth;
 	uint32_t schedule_exit[SCHEDULE_EXIT_COUNT];
 	uint32_t schedule_queue_len;
+	uint32_t schedule_shape_hits;
 
 	uint32_t jobs_submitted;
 	uint32_t jobs_started;
@@ -213,10 +214,18 @@ typedef struct diag_stats {
 	uint32_t bf_last_depth_try;
 	uint32_t bf_queue_len;
 	uint32_t bf_queue_len_sum;
+	uint32_t bf_shape_hits;
 	uint32_t bf_table_size;
 	uint32_t bf_table_size_sum;
 	time_t   bf_when_last_cycle;
 
+	uint32_t decay_cycle_counter;
+	uint32_t decay_cycle_last;
+	uint32_t decay_cycle_max;
+	uint64_t decay_cycle_sum;
+	uint32_t decay_jobs_calc;
+	uint32_t decay_jobs_skipped;
+
 	uint32_t latency;
 } diag_stats_t;
 
@@ -594,6 +603,9 @@ typedef struct {
 					 * scrontab) */
 	uint16_t orig_cpus_per_task;	/* requested value of cpus_per_task */
 	List depend_list;		/* list of job_ptr:state pairs */
+	int depend_rc;			/* last test_job_dependency() result */
+	bool depend_tested;		/* depend_rc is current, no depended
+					 * job changed state since */
 	char *dependency;		/* wait for other jobs */
 	char *orig_dependency;		/* original value (for archiving) */
 	uint16_t env_cnt;		/* size of env_sup (see below) */
@@ -1010,6 +1022,8 @@ typedef struct depend_spec {
 	job_record_t   *job_ptr;	/* pointer to this job */
 	uint64_t 	singleton_bits; /* which clusters have satisfied the
 					   singleton dependency */
+	bool		wake_set;	/* job_ptr's owner is registered to be
+					   woken when job_id changes state */
 } depend_spec_t;
 
 /* Used as the mode for update_node_active_features() */
@@ -53,14 +53,96 @@ extern buf_t *pack_all_stat(uint16_t protocol_version)
 	int agent_count;
 	int agent_thread_count;
 	int slurmdbd_queue_size = 0;
+	acct_storage_agent_stats_t dbd_stats = { 0 };
 	time_t now = time(NULL);
 
 	if (acct_storage_g_get_data(acct_db_conn, ACCT_STORAGE_INFO_AGENT_COUNT,
 				    &slurmdbd_queue_size) != SLURM_SUCCESS)
 		slurmdbd_queue_size = 0;
+	if (acct_storage_g_get_data(acct_db_conn, ACCT_STORAGE_INFO_AGENT_STATS,
+				    &dbd_stats) != SLURM_SUCCESS)
+		memset(&dbd_stats, 0, sizeof(dbd_stats));
 
 	buffer = init_buf(BUF_SIZE);
-	if (protocol_version >= SLURM_23_11_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_24_08_PROTOCOL_VERSION) {
+		pack32(1, buffer); /* please remove on next version */
+
+		pack_time(now, buffer);
+		debug3("%s: time = %lu", __func__, last_proc_req_start);
+		pack_time(last_proc_req_start, buffer);
+
+		slurm_mutex_lock(&slurmctld_config.thread_count_lock);
+		debug3("%s: server_thread_count = %u",
+		       __func__, slurmctld_config.server_thread_count);
+		pack32(slurmctld_config.server_thread_count, buffer);
+		slurm_mutex_unlock(&slurmctld_config.thread_count_lock);
+
+		agent_queue_size = retry_list_size();
+		pack32(agent_queue_size, buffer);
+		agent_count = get_agent_count();
+		pack32(agent_count, buffer);
+		agent_thread_count = get_agent_thread_count();
+		pack32(agent_thread_count, buffer);
+		pack32(slurmdbd_queue_size, buffer);
+		pack32(slurmctld_diag_stats.latency, buffer);
+
+		pack32(slurmctld_diag_stats.jobs_submitted, buffer);
+		pack32(slurmctld_diag_stats.jobs_started, buffer);
+		pack32(slurmctld_diag_stats.jobs_completed, buffer);
+		pack32(slurmctld_diag_stats.jobs_canceled, buffer);
+		pack32(slurmctld_diag_stats.jobs_failed, buffer);
+
+		pack32(slurmctld_diag_stats.jobs_pending, buffer);
+		pack32(slurmctld_diag_stats.jobs_running, buffer);
+		pack_time(slurmctld_diag_stats.job_states_ts, buffer);
+
+		pack32(slurmctld_diag_stats.schedule_cycle_max, buffer);
+		pack32(slurmctld_diag_stats.schedule_cycle_last, buffer);
+		pack32(slurmctld_diag_stats.schedule_cycle_sum, buffer);
+		pack32(slurmctld_diag_stats.schedule_cycle_counter, buffer);
+		pack32(slurmctld_diag_stats.schedule_cycle_depth, buffer);
+		pack32_array(slurmctld_diag_stats.schedule_exit,
+			     SCHEDULE_EXIT_COUNT, buffer);
+		pack32(slurmctld_diag_stats.schedule_queue_len, buffer);
+		pack32(slurmctld_diag_stats.schedule_shape_hits, buffer);
+
+		pack32(slurmctld_diag_stats.backfilled_jobs, buffer);
+		pack32(slurmctld_diag_stats.last_backfilled_jobs, buffer);
+		pack32(slurmctld_diag_stats.bf_cycle_counter, buffer);
+		pack64(slurmctld_diag_stats.bf_cycle_sum, buffer);
+		pack32(slurmctld_diag_stats.bf_cycle_last, buffer);
+		pack32(slurmctld_diag_stats.bf_last_depth, buffer);
+		pack32(slurmctld_diag_stats.bf_last_depth_try, buffer);
+
+		pack32(slurmctld_diag_stats.bf_queue_len, buffer);
+		pack32(slurmctld_diag_stats.bf_cycle_max, buffer);
+		pack_time(slurmctld_diag_stats.bf_when_last_cycle, buffer);
+		pack32(slurmctld_diag_stats.bf_depth_sum, buffer);
+		pack32(slurmctld_diag_stats.bf_depth_try_sum, buffer);
+		pack32(slurmctld_diag_stats.bf_queue_len_sum, buffer);
+		pack32(slurmctld_diag_stats.bf_table_size, buffer);
+		pack32(slurmctld_diag_stats.bf_table_size_sum, buffer);
+
+		pack32(slurmctld_diag_stats.bf_active, buffer);
+		pack32(slurmctld_diag_stats.backfilled_het_jobs, buffer);
+		pack32_array(slurmctld_diag_stats.bf_exit, BF_EXIT_COUNT,
+			     buffer);
+		pack32(slurmctld_diag_stats.bf_shape_hits, buffer);
+
+		pack32(slurmctld_diag_stats.decay_cycle_counter, buffer);
+		pack32(slurmctld_diag_stats.decay_cycle_last, buffer);
+		pack32(slurmctld_diag_stats.decay_cycle_max, buffer);
+		pack64(slurmctld_diag_stats.decay_cycle_sum, buffer);
+		pack32(slurmctld_diag_stats.decay_jobs_calc, buffer);
+		pack32(slurmctld_diag_stats.decay_jobs_skipped, buffer);
+
+		pack32(dbd_stats.queue_max, buffer);
+		pack32(dbd_stats.msgs_discarded, buffer);
+		pack32(dbd_stats.batches, buffer);
+		pack32(dbd_stats.latency_last, buffer);
+		pack32(dbd_stats.latency_max, buffer);
+		pack64(dbd_stats.latency_sum, buffer);
+	} else if (protocol_version >= SLURM_23_11_PROTOCOL_VERSION) {
 		pack32(1, buffer); /* please remove on next version */
 
 		pack_time(now, buffer);
@@ -195,6 +277,7 @@ extern void reset_stats(int level)
 	slurmctld_diag_stats.schedule_cycle_sum = 0;
 	slurmctld_diag_stats.schedule_cycle_counter = 0;
 	slurmctld_diag_stats.schedule_cycle_depth = 0;
+	slurmctld_diag_stats.schedule_shape_hits = 0;
 	slurmctld_diag_stats.jobs_submitted = 0;
 	slurmctld_diag_stats.jobs_started = 0;
 	slurmctld_diag_stats.jobs_completed = 0;
@@ -217,6 +300,11 @@ extern void reset_stats(int level)
 	slurmctld_diag_stats.bf_depth_try_sum = 0;
 	slurmctld_diag_stats.bf_queue_len = 0;
 	slurmctld_diag_stats.bf_queue_len_sum = 0;
+	slurmctld_diag_stats.bf_shape_hits = 0;
+	slurmctld_diag_stats.decay_cycle_counter = 0;
+	slurmctld_diag_stats.decay_cycle_last = 0;
+	slurmctld_diag_stats.decay_cycle_max = 0;
+	slurmctld_diag_stats.decay_cycle_sum = 0;
 	slurmctld_diag_stats.bf_table_size_sum = 0;
 	slurmctld_diag_stats.bf_cycle_max = 0;
 	slurmctld_diag_stats.bf_last_depth = 0;
@@ -34,8 +34,11 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#include <stddef.h>
+
 #include "src/common/pack.h"
 #include "src/common/slurm_protocol_pack.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
@@ -46,12 +49,21 @@
 /* FIXME: Y2038 problem */
 #define MAX_TIME 0x7fffffff
 
+/*
+ * Number of one second slots in the expiration wheels. Entries expiring
+ * further out than this stay in their slot until a later revolution.
+ */
+#define EXPIRE_WHEEL_SLOTS 256
+
 typedef struct {
+	/* step_id and ctime form the hash key, keep them first */
+	slurm_step_id_t step_id;/* Slurm step id for this credential	*/
 	time_t ctime;		/* Time that the cred was created	*/
 	time_t expiration;	/* Time at which cred is no longer good	*/
-	slurm_step_id_t step_id;/* Slurm step id for this credential	*/
 } cred_state_t;
 
+#define CRED_STATE_KEY_LEN offsetof(cred_state_t, expiration)
+
 typedef struct {
 	time_t ctime;		/* Time that this entry was created         */
 	time_t expiration;	/* Time at which credentials can be purged  */
@@ -60,8 +72,20 @@ typedef struct {
 } job_state_t;
 
 static pthread_mutex_t cred_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
-static list_t *cred_job_list = NULL;
-static list_t *cred_state_list = NULL;
+static xhash_t *cred_job_hash = NULL;	/* job_state_t by jobid */
+static xhash_t *cred_state_hash = NULL;	/* cred_state_t by step and ctime */
+
+/*
+ * Expiration wheels. Slots hold copies of the hash keys (jobid or
+ * cred_state_t) of entries that may expire during that second, entries are
+ * validated against the hash tables when their slot comes up.
+ */
+static list_t *job_expire_wheel[EXPIRE_WHEEL_SLOTS];
+static list_t *cred_expire_wheel[EXPIRE_WHEEL_SLOTS];
+static time_t expire_wheel_time = 0;	/* last second processed */
+
+/* Set when state changed since it was last written by save_cred_state() */
+static bool cred_state_dirty = true;
 
 static void _drain_node(char *reason)
 {
@@ -75,74 +99,165 @@ static void _drain_node(char *reason)
 	(void) slurm_update_node(&update_node_msg);
 }
 
-static cred_state_t *_cred_state_create(slurm_cred_t *cred)
+static void _job_state_id(void *item, const char **key, uint32_t *key_len)
 {
-	cred_state_t *s = xmalloc(sizeof(*s));
+	job_state_t *j = item;
 
-	memcpy(&s->step_id, &cred->arg->step_id, sizeof(s->step_id));
-	s->ctime = cred->ctime;
-	s->expiration = cred->ctime + cred_expiration();
+	*key = (const char *) &j->jobid;
+	*key_len = sizeof(j->jobid);
+}
 
-	return s;
+static void _cred_state_id(void *item, const char **key, uint32_t *key_len)
+{
+	*key = item;
+	*key_len = CRED_STATE_KEY_LEN;
 }
 
-static job_state_t *_job_state_create(uint32_t jobid)
+/* Queue key for a check once expiration has passed */
+static void _expire_wheel_add(list_t **wheel, time_t expiration, void *key)
 {
-	job_state_t *j = xmalloc(sizeof(*j));
+	time_t when = expiration + 1;
+	int slot;
 
-	j->jobid = jobid;
-	j->revoked = (time_t) 0;
-	j->ctime = time(NULL);
-	j->expiration = (time_t) MAX_TIME;
+	if (when <= expire_wheel_time)
+		when = expire_wheel_time + 1;
+	slot = when % EXPIRE_WHEEL_SLOTS;
 
-	return j;
+	if (!wheel[slot])
+		wheel[slot] = list_create(xfree_ptr);
+	list_append(wheel[slot], key);
 }
 
-static int _list_find_expired_job_state(void *x, void *key)
+static void _job_expire_add(job_state_t *j)
 {
-	job_state_t *j = x;
-	time_t curr_time = *(time_t *) key;
+	uint32_t *jobid;
 
-	if (j->revoked && (curr_time > j->expiration))
-		return 1;
-	return 0;
+	if (!j->revoked || (j->expiration == (time_t) MAX_TIME))
+		return;
+
+	jobid = xmalloc(sizeof(*jobid));
+	*jobid = j->jobid;
+	_expire_wheel_add(job_expire_wheel, j->expiration, jobid);
 }
 
-static int _list_find_job_state(void *x, void *key)
+static void _cred_expire_add(cred_state_t *s)
 {
-	job_state_t *j = x;
-	uint32_t jobid = *(uint32_t *) key;
+	cred_state_t *key = xmalloc(sizeof(*key));
 
-	if (j->jobid == jobid)
-		return 1;
-	return 0;
+	memcpy(key, s, sizeof(*key));
+	_expire_wheel_add(cred_expire_wheel, s->expiration, key);
 }
 
 static job_state_t *_find_job_state(uint32_t jobid)
 {
-	return list_find_first(cred_job_list, _list_find_job_state, &jobid);
+	return xhash_get(cred_job_hash, (char *) &jobid, sizeof(jobid));
 }
 
-static void _clear_expired_job_states(void)
+static void _add_job_state(job_state_t *j)
 {
-	time_t now = time(NULL);
-	list_delete_all(cred_job_list, _list_find_expired_job_state, &now);
+	xhash_add(cred_job_hash, j);
+	cred_state_dirty = true;
 }
 
-static int _list_find_expired_cred_state(void *x, void *key)
+static void _add_cred_state(cred_state_t *s)
+{
+	xhash_add(cred_state_hash, s);
+	_cred_expire_add(s);
+	cred_state_dirty = true;
+}
+
+/* Returns 1 when the wheel entry is no longer needed */
+static int _expire_job_state(void *x, void *key)
+{
+	uint32_t jobid = *(uint32_t *) x;
+	time_t curr_time = *(time_t *) key;
+	job_state_t *j = _find_job_state(jobid);
+
+	/* Entry gone, or re-queued on the wheel if expiration gets set again */
+	if (!j || !j->revoked || (j->expiration == (time_t) MAX_TIME))
+		return 1;
+
+	if (curr_time > j->expiration) {
+		xhash_delete(cred_job_hash, (char *) &jobid, sizeof(jobid));
+		return 1;
+	}
+
+	return 0;
+}
+
+static int _expire_cred_state(void *x, void *key)
 {
-	cred_state_t *s = x;
 	time_t curr_time = *(time_t *) key;
+	cred_state_t *s = xhash_get(cred_state_hash, x, CRED_STATE_KEY_LEN);
+
+	if (!s)
+		return 1;
 
-	if (curr_time > s->expiration)
+	if (curr_time > s->expiration) {
+		xhash_delete(cred_state_hash, x, CRED_STATE_KEY_LEN);
 		return 1;
+	}
+
 	return 0;
 }
 
-static void _clear_expired_credential_states(void)
+/* Purge expired job and credential states, cred_cache_mutex must be held */
+static void _clear_expired_states(void)
 {
 	time_t now = time(NULL);
-	list_delete_all(cred_state_list, _list_find_expired_cred_state, &now);
+	time_t t;
+
+	if (now <= expire_wheel_time)
+		return;
+
+	t = expire_wheel_time + 1;
+	if (!expire_wheel_time || ((now - t) >= EXPIRE_WHEEL_SLOTS))
+		t = now - EXPIRE_WHEEL_SLOTS + 1;
+
+	for (; t <= now; t++) {
+		int slot = t % EXPIRE_WHEEL_SLOTS;
+
+		if (job_expire_wheel[slot])
+			list_delete_all(job_expire_wheel[slot],
+					_expire_job_state, &now);
+		if (cred_expire_wheel[slot])
+			list_delete_all(cred_expire_wheel[slot],
+					_expire_cred_state, &now);
+	}
+
+	expire_wheel_time = now;
+}
+
+static void _expire_wheel_fini(void)
+{
+	for (int i = 0; i < EXPIRE_WHEEL_SLOTS; i++) {
+		FREE_NULL_LIST(job_expire_wheel[i]);
+		FREE_NULL_LIST(cred_expire_wheel[i]);
+	}
+	expire_wheel_time = 0;
+}
+
+static cred_state_t *_cred_state_create(slurm_cred_t *cred)
+{
+	cred_state_t *s = xmalloc(sizeof(*s));
+
+	memcpy(&s->step_id, &cred->arg->step_id, sizeof(s->step_id));
+	s->ctime = cred->ctime;
+	s->expiration = cred->ctime + cred_expiration();
+
+	return s;
+}
+
+static job_state_t *_job_state_create(uint32_t jobid)
+{
+	job_state_t *j = xmalloc(sizeof(*j));
+
+	j->jobid = jobid;
+	j->revoked = (time_t) 0;
+	j->ctime = time(NULL);
+	j->expiration = (time_t) MAX_TIME;
+
+	return j;
 }
 
 static void _job_state_pack(void *x, uint16_t protocol_version, buf_t *buffer)
@@ -212,37 +327,85 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
-static void _cred_context_pack(buf_t *buffer)
+typedef struct {
+	buf_t *buffer;
+	void (*pack_function) (void *object, uint16_t protocol_version,
+			       buf_t *buffer);
+	uint16_t protocol_version;
+} pack_hash_args_t;
+
+static void _pack_hash_item(void *item, void *arg)
+{
+	pack_hash_args_t *args = arg;
+
+	(args->pack_function)(item, args->protocol_version, args->buffer);
+}
+
+/* Pack hash table contents in the same format as slurm_pack_list() */
+static void _pack_hash(xhash_t *table,
+		       void (*pack_function) (void *object,
+					      uint16_t protocol_version,
+					      buf_t *buffer),
+		       buf_t *buffer, uint16_t protocol_version)
+{
+	pack_hash_args_t args = {
+		.buffer = buffer,
+		.pack_function = pack_function,
+		.protocol_version = protocol_version,
+	};
+
+	pack32(xhash_count(table), buffer);
+	xhash_walk(table, _pack_hash_item, &args);
+}
+
+/* Returns NULL if nothing changed since the last time state was packed */
+static buf_t *_cred_context_pack(void)
 {
 	/* FIXME: find a way to version this file at some point */
 	uint16_t version = SLURM_PROTOCOL_VERSION;
+	buf_t *buffer = NULL;
 
 	slurm_mutex_lock(&cred_cache_mutex);
-	slurm_pack_list(cred_job_list, _job_state_pack, buffer, version);
-	slurm_pack_list(cred_state_list, _cred_state_pack, buffer, version);
+	if (cred_state_dirty) {
+		buffer = init_buf(1024);
+		_pack_hash(cred_job_hash, _job_state_pack, buffer, version);
+		_pack_hash(cred_state_hash, _cred_state_pack, buffer, version);
+		cred_state_dirty = false;
+	}
 	slurm_mutex_unlock(&cred_cache_mutex);
+
+	return buffer;
 }
 
 static void _cred_context_unpack(buf_t *buffer)
 {
 	/* FIXME: find a way to version this file at some point */
 	uint16_t version = SLURM_PROTOCOL_VERSION;
+	list_t *tmp_list = NULL;
+	job_state_t *j;
+	cred_state_t *s;
 
 	slurm_mutex_lock(&cred_cache_mutex);
 
-	FREE_NULL_LIST(cred_job_list);
-	if (slurm_unpack_list(&cred_job_list, _job_state_unpack,
+	if (slurm_unpack_list(&tmp_list, _job_state_unpack,
 			      xfree_ptr, buffer, version)) {
 		warning("%s: failed to restore job state from file", __func__);
 	}
-	_clear_expired_job_states();
+	while (tmp_list && (j = list_pop(tmp_list))) {
+		_add_job_state(j);
+		_job_expire_add(j);
+	}
+	FREE_NULL_LIST(tmp_list);
 
-	FREE_NULL_LIST(cred_state_list);
-	if (slurm_unpack_list(&cred_state_list, _cred_state_unpack,
+	if (slurm_unpack_list(&tmp_list, _cred_state_unpack,
 			      xfree_ptr, buffer, version)) {
 		warning("%s: failed to restore job state from file", __func__);
 	}
-	_clear_expired_credential_states();
+	while (tmp_list && (s = list_pop(tmp_list)))
+		_add_cred_state(s);
+	FREE_NULL_LIST(tmp_list);
+
+	_clear_expired_states();
 
 	slurm_mutex_unlock(&cred_cache_mutex);
 }
@@ -260,28 +423,36 @@ extern void save_cred_state(void)
 	xstrcat(new_file, "/cred_state.new");
 
 	slurm_mutex_lock(&state_mutex);
+	if (!(buffer = _cred_context_pack())) {
+		debug3("%s: no changes to save", __func__);
+		goto cleanup;
+	}
 	if ((cred_fd = creat(new_file, 0600)) < 0) {
 		error("creat(%s): %m", new_file);
 		if (errno == ENOSPC)
 			_drain_node("SlurmdSpoolDir is full");
-		goto cleanup;
+		goto fail;
 	}
-	buffer = init_buf(1024);
-	_cred_context_pack(buffer);
 	rc = write(cred_fd, get_buf_data(buffer), get_buf_offset(buffer));
 	if (rc != get_buf_offset(buffer)) {
 		error("write %s error %m", new_file);
 		(void) unlink(new_file);
 		if ((rc < 0) && (errno == ENOSPC))
 			_drain_node("SlurmdSpoolDir is full");
-		goto cleanup;
+		goto fail;
 	}
 	(void) unlink(reg_file);
 	if (link(new_file, reg_file))
 		debug4("unable to create link for %s -> %s: %m",
 		       new_file, reg_file);
 	(void) unlink(new_file);
+	goto cleanup;
 
+fail:
+	/* Make sure the next call tries again */
+	slurm_mutex_lock(&cred_cache_mutex);
+	cred_state_dirty = true;
+	slurm_mutex_unlock(&cred_cache_mutex);
 cleanup:
 	slurm_mutex_unlock(&state_mutex);
 	xfree(reg_file);
@@ -311,20 +482,26 @@ cleanup:
 
 extern void cred_state_init(void)
 {
+	slurm_mutex_lock(&cred_cache_mutex);
+	if (!cred_job_hash)
+		cred_job_hash = xhash_init(_job_state_id, xfree_ptr);
+	if (!cred_state_hash)
+		cred_state_hash = xhash_init(_cred_state_id, xfree_ptr);
+	slurm_mutex_unlock(&cred_cache_mutex);
+
 	if (!conf->cleanstart)
 		_restore_cred_state();
-
-	if (!cred_job_list)
-		cred_job_list = list_create(xfree_ptr);
-	if (!cred_state_list)
-		cred_state_list = list_create(xfree_ptr);
 }
 
 extern void cred_state_fini(void)
 {
 	save_cred_state();
-	FREE_NULL_LIST(cred_job_list);
-	FREE_NULL_LIST(cred_state_list);
+
+	slurm_mutex_lock(&cred_cache_mutex);
+	xhash_free(cred_job_hash);
+	xhash_free(cred_state_hash);
+	_expire_wheel_fini();
+	slurm_mutex_unlock(&cred_cache_mutex);
 }
 
 extern bool cred_jobid_cached(uint32_t jobid)
@@ -332,7 +509,7 @@ extern bool cred_jobid_cached(uint32_t jobid)
 	bool retval = false;
 
 	slurm_mutex_lock(&cred_cache_mutex);
-	_clear_expired_job_states();
+	_clear_expired_states();
 	retval = (_find_job_state(jobid) != NULL);
 	slurm_mutex_unlock(&cred_cache_mutex);
 
@@ -342,13 +519,13 @@ extern bool cred_jobid_cached(uint32_t jobid)
 extern int cred_insert_jobid(uint32_t jobid)
 {
 	slurm_mutex_lock(&cred_cache_mutex);
-	_clear_expired_job_states();
+	_clear_expired_states();
 	if (_find_job_state(jobid)) {
 		debug2("%s: we already have a job state for job %u.",
 		       __func__, jobid);
 	} else {
 		job_state_t *j = _job_state_create(jobid);
-		list_append(cred_job_list, j);
+		_add_job_state(j);
 	}
 	slurm_mutex_unlock(&cred_cache_mutex);
 
@@ -361,7 +538,7 @@ extern int cred_revoke(uint32_t jobid, time_t time, time_t start_time)
 
 	slurm_mutex_lock(&cred_cache_mutex);
 
-	_clear_expired_job_states();
+	_clear_expired_states();
 
 	if (!(j = _find_job_state(jobid))) {
 		/*
@@ -370,7 +547,7 @@ extern int cred_revoke(uint32_t jobid, time_t time, time_t start_time)
 		 * credentials.
 		 */
 		j = _job_state_create(jobid);
-		list_append(cred_job_list, j);
+		_add_job_state(j);
 	}
 	if (j->revoked) {
 		if (start_time && (j->revoked < start_time)) {
@@ -383,6 +560,8 @@ extern int cred_revoke(uint32_t jobid, time_t time, time_t start_time)
 	}
 
 	j->revoked = time;
+	_job_expire_add(j);
+	cred_state_dirty = true;
 
 	slurm_mutex_unlock(&cred_cache_mutex);
 	return SLURM_SUCCESS;
@@ -415,7 +594,7 @@ extern int cred_begin_expiration(uint32_t jobid)
 
 	slurm_mutex_lock(&cred_cache_mutex);
 
-	_clear_expired_job_states();
+	_clear_expired_states();
 
 	if (!(j = _find_job_state(jobid))) {
 		slurm_seterrno(ESRCH);
@@ -428,6 +607,8 @@ extern int cred_begin_expiration(uint32_t jobid)
 	}
 
 	j->expiration = time(NULL) + cred_expiration();
+	_job_expire_add(j);
+	cred_state_dirty = true;
 	debug2("set revoke expiration for jobid %u to %ld UTS",
 	       j->jobid, j->expiration);
 	slurm_mutex_unlock(&cred_cache_mutex);
@@ -452,7 +633,9 @@ extern void cred_handle_reissue(slurm_cred_t *cred, bool locked)
 		 * old record so that "cred" will look like a new
 		 * credential to any ensuing commands. */
 		info("reissued job credential for job %u", j->jobid);
-		list_delete_ptr(cred_job_list, j);
+		xhash_delete(cred_job_hash, (char *) &j->jobid,
+			     sizeof(j->jobid));
+		cred_state_dirty = true;
 	}
 
 	if (!locked)
@@ -465,7 +648,7 @@ static bool _credential_revoked(slurm_cred_t *cred)
 
 	if (!(j = _find_job_state(cred->arg->step_id.job_id))) {
 		j = _job_state_create(cred->arg->step_id.job_id);
-		list_append(cred_job_list, j);
+		_add_job_state(j);
 		return false;
 	}
 
@@ -478,35 +661,25 @@ static bool _credential_revoked(slurm_cred_t *cred)
 	return false;
 }
 
-static int _list_find_cred_state(void *x, void *key)
-{
-	cred_state_t *s = x;
-	slurm_cred_t *cred = key;
-
-	if (!memcmp(&s->step_id, &cred->arg->step_id, sizeof(s->step_id)) &&
-	    (s->ctime == cred->ctime))
-		return 1;
-
-	return 0;
-}
-
 static bool _credential_replayed(slurm_cred_t *cred)
 {
-	cred_state_t *s = NULL;
+	cred_state_t key;
 
-	s = list_find_first(cred_state_list, _list_find_cred_state, cred);
+	/* zero any padding, the whole key is hashed */
+	memset(&key, 0, sizeof(key));
+	memcpy(&key.step_id, &cred->arg->step_id, sizeof(key.step_id));
+	key.ctime = cred->ctime;
 
 	/*
 	 * If we found a match, this credential is being replayed.
 	 */
-	if (s)
+	if (xhash_get(cred_state_hash, (char *) &key, CRED_STATE_KEY_LEN))
 		return true;
 
 	/*
 	 * Otherwise, save the credential state
 	 */
-	s = _cred_state_create(cred);
-	list_append(cred_state_list, s);
+	_add_cred_state(_cred_state_create(cred));
 
 	return false;
 }
@@ -515,8 +688,7 @@ extern bool cred_cache_valid(slurm_cred_t *cred)
 {
 	slurm_mutex_lock(&cred_cache_mutex);
 
-	_clear_expired_job_states();
-	_clear_expired_credential_states();
+	_clear_expired_states();
 
 	cred_handle_reissue(cred, true);
 
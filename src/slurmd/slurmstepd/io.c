@@ -56,6 +56,7 @@
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -426,13 +427,19 @@ _client_read(eio_obj_t *obj, List objs)
 
 /*
  * Write outgoing packed messages to the client socket.
+ *
+ * As many queued messages as possible (up to STDIO_MAX_WRITEV) are sent with
+ * a single writev() call.
  */
 static int
 _client_write(eio_obj_t *obj, List objs)
 {
 	struct client_io_info *client = (struct client_io_info *) obj->arg;
-	void *buf;
-	int n;
+	struct iovec iov[STDIO_MAX_WRITEV];
+	struct io_buf *msg;
+	list_itr_t *itr;
+	int iovcnt = 0;
+	ssize_t n;
 
 	xassert(client->magic == CLIENT_IO_MAGIC);
 
@@ -456,12 +463,27 @@ _client_write(eio_obj_t *obj, List objs)
 	debug5("  client->out_remaining = %d", client->out_remaining);
 
 	/*
-	 * Write message to socket.
+	 * Gather the rest of the current message and the messages queued
+	 * behind it. They stay on the queue until fully written.
 	 */
-	buf = client->out_msg->data +
+	iov[iovcnt].iov_base = client->out_msg->data +
 		(client->out_msg->length - client->out_remaining);
+	iov[iovcnt].iov_len = client->out_remaining;
+	iovcnt++;
+
+	itr = list_iterator_create(client->msg_queue);
+	while ((iovcnt < STDIO_MAX_WRITEV) && (msg = list_next(itr))) {
+		iov[iovcnt].iov_base = msg->data;
+		iov[iovcnt].iov_len = msg->length;
+		iovcnt++;
+	}
+	list_iterator_destroy(itr);
+
+	/*
+	 * Write messages to socket.
+	 */
 again:
-	if ((n = write(obj->fd, buf, client->out_remaining)) < 0) {
+	if ((n = writev(obj->fd, iov, iovcnt)) < 0) {
 		if (errno == EINTR) {
 			goto again;
 		} else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
@@ -474,17 +496,22 @@ again:
 			return SLURM_SUCCESS;
 		}
 	}
-	if (n < client->out_remaining) {
-		error("Only wrote %d of %d bytes to socket",
-		      n, client->out_remaining);
-	} else
-		debug5("Wrote %d bytes to socket", n);
-	client->out_remaining -= n;
-	if (client->out_remaining > 0)
-		return SLURM_SUCCESS;
+	debug5("Wrote %zd bytes from %d messages to socket", n, iovcnt);
+	client->step->io_bytes_written += n;
+	client->step->io_write_calls++;
 
-	_free_outgoing_msg(client->out_msg, client->step);
-	client->out_msg = NULL;
+	/* Release every message that was completely written */
+	while (client->out_msg && (n >= client->out_remaining)) {
+		n -= client->out_remaining;
+		_free_outgoing_msg(client->out_msg, client->step);
+		if (--iovcnt && (client->out_msg =
+				 list_dequeue(client->msg_queue)))
+			client->out_remaining = client->out_msg->length;
+		else
+			client->out_msg = NULL;
+	}
+	if (client->out_msg)
+		client->out_remaining -= n;
 
 	return SLURM_SUCCESS;
 }
@@ -712,7 +739,7 @@ _create_task_out_eio(int fd, uint16_t type,
 	out->gtaskid = task->gtid;
 	out->ltaskid = task->id;
 	out->step = step;
-	out->buf = cbuf_create(MAX_MSG_LEN, MAX_MSG_LEN*4);
+	out->buf = cbuf_create(MAX_MSG_LEN, STDIO_MAX_TASK_BUF);
 	out->eof = false;
 	out->eof_msg_sent = false;
 	if (cbuf_opt_set(out->buf, CBUF_OPT_OVERWRITE, CBUF_NO_DROP) == -1)
@@ -775,6 +802,8 @@ again:
 		if (rc <= 0) {  /* got eof */
 			debug5("  got eof on task");
 			out->eof = true;
+		} else {
+			out->step->io_bytes_read += rc;
 		}
 	}
 
@@ -1465,11 +1494,26 @@ io_close_local_fds(stepd_step_rec_t *step)
 
 
 
+static void _log_io_stats(stepd_step_rec_t *step, time_t elapsed)
+{
+	if (!step->io_bytes_read && !step->io_bytes_written)
+		return;
+
+	if (elapsed < 1)
+		elapsed = 1;
+
+	debug("IO stats: read %"PRIu64" bytes from tasks (%"PRIu64" bytes/sec), wrote %"PRIu64" bytes to clients in %"PRIu64" writes (%"PRIu64" bytes/sec)",
+	      step->io_bytes_read, step->io_bytes_read / elapsed,
+	      step->io_bytes_written, step->io_write_calls,
+	      step->io_bytes_written / elapsed);
+}
+
 static void *
 _io_thr(void *arg)
 {
 	stepd_step_rec_t *step = (stepd_step_rec_t *) arg;
 	sigset_t set;
+	time_t start;
 	int rc;
 
 	/* A SIGHUP signal signals a reattach to the mgr thread.  We need
@@ -1482,8 +1526,10 @@ _io_thr(void *arg)
 	pthread_sigmask(SIG_BLOCK, &set, NULL);
 
 	debug("IO handler started pid=%lu", (unsigned long) getpid());
+	start = time(NULL);
 	rc = eio_handle_mainloop(step->eio);
 	debug("IO handler exited, rc=%d", rc);
+	_log_io_stats(step, time(NULL) - start);
 	slurm_mutex_lock(&step->io_mutex);
 	step->io_running = false;
 	slurm_cond_broadcast(&step->io_cond);
@@ -40,6 +40,7 @@
 #define _IO_H
 
 #include "src/common/eio.h"
+#include "src/common/io_hdr.h"
 
 #include "src/slurmd/slurmstepd/slurmstepd_job.h"
 
@@ -50,6 +51,16 @@
 #define STDIO_MAX_FREE_BUF 1024
 #define STDIO_MAX_MSG_CACHE 128
 
+/*
+ * Task stdout/stderr are read into a cbuf that starts at MAX_MSG_LEN and grows
+ * as needed up to STDIO_MAX_TASK_BUF, so chatty tasks are drained with fewer
+ * read calls while the clients catch up.
+ */
+#define STDIO_MAX_TASK_BUF (MAX_MSG_LEN * 16)
+
+/* Max number of queued messages sent to a client in a single writev() */
+#define STDIO_MAX_WRITEV 64
+
 struct io_buf {
 	int ref_count;
 	uint32_t length;
@@ -225,6 +225,9 @@ typedef struct {
 	List outgoing_cache;  /* cache of outgoing stdio messages
 			       * used when a new client attaches
 			       */
+	uint64_t io_bytes_read;	   /* bytes read from task stdout/stderr */
+	uint64_t io_bytes_written; /* bytes written to remote clients */
+	uint64_t io_write_calls;   /* write syscalls to remote clients */
 
 	bool io_running;		/* I/O thread running */
 	pthread_cond_t io_cond;		/* I/O thread state conditional */
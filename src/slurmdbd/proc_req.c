@@ -60,6 +60,7 @@
 #include "src/slurmdbd/read_config.h"
 #include "src/slurmdbd/rpc_mgr.h"
 #include "src/slurmdbd/proc_req.h"
+#include "src/slurmdbd/query_cache.h"
 #include "src/slurmdbd/slurmdbd.h"
 #include "src/slurmctld/slurmctld.h"
 
@@ -85,6 +86,11 @@ static void _process_job_start(slurmdbd_conn_t *slurmdbd_conn,
 __thread bool drop_priv = false;
 #endif
 
+/* Queries from users being processed, limited by MaxQueryThreads */
+static pthread_mutex_t query_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t query_cond = PTHREAD_COND_INITIALIZER;
+static uint16_t query_cnt = 0;
+
 /*
  * _validate_slurm_user - validate that the uid is authorized to see
  *      privileged data (either user root or SlurmUser)
@@ -3172,6 +3178,21 @@ static int _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 
 	list_msg.my_list = list_create(slurmdbd_free_buffer);
 	/* START_TIMER; */
+
+	/*
+	 * Handle the whole batch in one transaction and let the storage group
+	 * the rows of similar messages into multi-row inserts. With
+	 * CommitDelay the transaction may still hold earlier requests which
+	 * were already acknowledged, commit them first so a failed batch only
+	 * rolls back its own rows.
+	 */
+	if (slurmdbd_conf->commit_delay) {
+		acct_storage_g_commit(slurmdbd_conn->db_conn, 1);
+		query_cache_committed(slurmdbd_conn);
+	}
+	slurmdbd_conn->in_mult_msg = true;
+	acct_storage_g_bulk_write(slurmdbd_conn->db_conn, true);
+
 	itr = list_iterator_create(get_msg->my_list);
 	while ((req_buf = list_next(itr))) {
 		persist_msg_t sub_msg;
@@ -3194,6 +3215,23 @@ static int _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 			break;
 	}
 	list_iterator_destroy(itr);
+
+	slurmdbd_conn->in_mult_msg = false;
+	if (acct_storage_g_bulk_write(slurmdbd_conn->db_conn, false) !=
+	    SLURM_SUCCESS) {
+		/*
+		 * Some grouped rows were not written. Roll the batch back and
+		 * acknowledge nothing so the slurmctld sends it all again.
+		 */
+		comment = "Grouped insert of DBD_SEND_MULT_MSG failed";
+		error("%s", comment);
+		acct_storage_g_commit(slurmdbd_conn->db_conn, 0);
+		list_flush(list_msg.my_list);
+		list_append(list_msg.my_list,
+			    slurm_persist_make_rc_msg(slurmdbd_conn->conn,
+						      SLURM_ERROR, comment,
+						      DBD_SEND_MULT_MSG));
+	}
 	/* END_TIMER; */
 	/* info("%d multi took %s", list_count(get_msg->my_list), TIME_STR); */
 
@@ -3382,6 +3420,7 @@ static int _get_stats(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 	*out_buffer = init_buf(32 * 1024);
 	pack16((uint16_t) DBD_GOT_STATS, *out_buffer);
 	slurm_mutex_lock(&rpc_mutex);
+	rpc_stats.query_cache_entries = query_cache_count();
 	slurmdb_pack_stats_msg(&rpc_stats, slurmdbd_conn->conn->version,
 			       *out_buffer);
 	slurm_mutex_unlock(&rpc_mutex);
@@ -3441,6 +3480,130 @@ static int _shutdown(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 	return rc;
 }
 
+/*
+ * Return true if msg_type may change anything replies in the query cache are
+ * made from. Job and step records are not part of any cached reply, usage
+ * made from them only changes with a rollup.
+ */
+static bool _query_cache_invalidates(slurmdbd_msg_type_t msg_type)
+{
+	switch (msg_type) {
+	case REQUEST_PERSIST_INIT:
+	case DBD_ADD_RESV:
+	case DBD_CLEAR_STATS:
+	case DBD_FINI:
+	case DBD_FLUSH_JOBS:
+	case DBD_GET_ACCOUNTS:
+	case DBD_GET_ASSOCS:
+	case DBD_GET_ASSOC_USAGE:
+	case DBD_GET_CLUSTERS:
+	case DBD_GET_CLUSTER_USAGE:
+	case DBD_GET_CONFIG:
+	case DBD_GET_EVENTS:
+	case DBD_GET_FEDERATIONS:
+	case DBD_GET_INSTANCES:
+	case DBD_GET_JOBS_COND:
+	case DBD_GET_PROBS:
+	case DBD_GET_QOS:
+	case DBD_GET_RES:
+	case DBD_GET_RESVS:
+	case DBD_GET_STATS:
+	case DBD_GET_TRES:
+	case DBD_GET_TXN:
+	case DBD_GET_USERS:
+	case DBD_GET_WCKEYS:
+	case DBD_GET_WCKEY_USAGE:
+	case DBD_JOB_COMPLETE:
+	case DBD_JOB_HEAVY:
+	case DBD_JOB_START:
+	case DBD_JOB_SUSPEND:
+	case DBD_MODIFY_JOB:
+	case DBD_MODIFY_RESV:
+	case DBD_NODE_STATE:
+	case DBD_REMOVE_RESV:
+	case DBD_SEND_MULT_JOB_START:
+	case DBD_SEND_MULT_MSG:
+	case DBD_SHUTDOWN:
+	case DBD_STEP_COMPLETE:
+	case DBD_STEP_START:
+		return false;
+	default:
+		return true;
+	}
+}
+
+/*
+ * Wait until a query from a user may run, so a few large queries can not take
+ * the database away from the slurmctld traffic. The slurmctld is never held
+ * back, neither are requests that do not read from the database.
+ * RET true if a slot was taken, release it with _query_slot_put()
+ */
+static bool _query_slot_get(slurmdbd_conn_t *slurmdbd_conn,
+			    slurmdbd_msg_type_t msg_type)
+{
+	bool waited = false;
+
+	if (slurmdbd_conn->conn->rem_port || !slurmdbd_conf->max_query_threads)
+		return false;
+
+	switch (msg_type) {
+	case DBD_GET_ACCOUNTS:
+	case DBD_GET_ASSOCS:
+	case DBD_GET_ASSOC_USAGE:
+	case DBD_GET_CLUSTERS:
+	case DBD_GET_CLUSTER_USAGE:
+	case DBD_GET_EVENTS:
+	case DBD_GET_FEDERATIONS:
+	case DBD_GET_INSTANCES:
+	case DBD_GET_JOBS_COND:
+	case DBD_GET_PROBS:
+	case DBD_GET_QOS:
+	case DBD_GET_RES:
+	case DBD_GET_RESVS:
+	case DBD_GET_TRES:
+	case DBD_GET_TXN:
+	case DBD_GET_USERS:
+	case DBD_GET_WCKEYS:
+	case DBD_GET_WCKEY_USAGE:
+		break;
+	default:
+		return false;
+	}
+
+	slurm_mutex_lock(&query_lock);
+	/* MaxQueryThreads may be changed, even to unlimited, by reconfigure */
+	while (slurmdbd_conf->max_query_threads &&
+	       (query_cnt >= slurmdbd_conf->max_query_threads)) {
+		waited = true;
+		slurm_cond_wait(&query_cond, &query_lock);
+	}
+	query_cnt++;
+	slurm_mutex_unlock(&query_lock);
+
+	if (waited)
+		debug2("%s: %s from uid %u waited for MaxQueryThreads",
+		       __func__, slurmdbd_msg_type_2_str(msg_type, 1),
+		       slurmdbd_conn->conn->auth_uid);
+
+	return true;
+}
+
+static void _query_slot_put(void)
+{
+	slurm_mutex_lock(&query_lock);
+	query_cnt--;
+	slurm_cond_signal(&query_cond);
+	slurm_mutex_unlock(&query_lock);
+}
+
+extern void proc_req_reconfig(void)
+{
+	/* Let the queries waiting for a slot see the new MaxQueryThreads */
+	slurm_mutex_lock(&query_lock);
+	slurm_cond_broadcast(&query_cond);
+	slurm_mutex_unlock(&query_lock);
+}
+
 /* Process an incoming RPC
  * slurmdbd_conn IN/OUT - in will that the conn.fd set before
  *       calling and db_conn and conn.version will be filled in with the init.
@@ -3456,6 +3619,9 @@ extern int proc_req(void *conn, persist_msg_t *msg, buf_t **out_buffer)
 	int rc = SLURM_SUCCESS;
 	char *comment = NULL;
 	slurmdb_rpc_obj_t *rpc_obj;
+	query_cache_key_t *cache_key = NULL;
+	bool cache_hit = false, cache_miss = false, committed = false;
+	bool query_slot;
 
 	DEF_TIMERS;
 	START_TIMER;
@@ -3478,6 +3644,13 @@ extern int proc_req(void *conn, persist_msg_t *msg, buf_t **out_buffer)
 		}
 	}
 
+	if ((cache_hit = query_cache_get(slurmdbd_conn, msg, &cache_key,
+					 out_buffer)))
+		goto end_it;
+	cache_miss = (cache_key != NULL);
+
+	query_slot = _query_slot_get(slurmdbd_conn, msg->msg_type);
+
 	switch (msg->msg_type) {
 	case REQUEST_PERSIST_INIT:
 		rc = _unpack_persist_init(slurmdbd_conn, msg, out_buffer);
@@ -3714,11 +3887,14 @@ extern int proc_req(void *conn, persist_msg_t *msg, buf_t **out_buffer)
 		break;
 	}
 
+	if (query_slot)
+		_query_slot_put();
+
 	if (rc == ESLURM_ACCESS_DENIED)
 		error("CONN:%d Security violation, %s",
 		      slurmdbd_conn->conn->fd,
 		      slurmdbd_msg_type_2_str(msg->msg_type, 1));
-	else if (slurmdbd_conn->conn->rem_port &&
+	else if (slurmdbd_conn->conn->rem_port && !slurmdbd_conn->in_mult_msg &&
 		 (!slurmdbd_conf->commit_delay ||
 		  (msg->msg_type == DBD_REGISTER_CTLD))) {
 		/* If we are dealing with the slurmctld do the
@@ -3727,7 +3903,36 @@ extern int proc_req(void *conn, persist_msg_t *msg, buf_t **out_buffer)
 		   (don't ever use autocommit with innodb)
 		*/
 		acct_storage_g_commit(slurmdbd_conn->db_conn, 1);
+		committed = true;
+	}
+
+	if (cache_key) {
+		bool replica_read = false;
+
+		/*
+		 * A read replica may lag behind the last invalidation, so its
+		 * reply could be kept longer than the allowed lag.
+		 */
+		(void) acct_storage_g_get_data(slurmdbd_conn->db_conn,
+					       ACCT_STORAGE_INFO_REPLICA_READ,
+					       &replica_read);
+		if ((rc == SLURM_SUCCESS) && !replica_read)
+			query_cache_add(slurmdbd_conn, &cache_key,
+					*out_buffer);
+		else
+			query_cache_free_key(&cache_key);
 	}
+
+	/*
+	 * Cached replies have to go once changes are visible to other
+	 * connections, that is on commit.
+	 */
+	if (_query_cache_invalidates(msg->msg_type))
+		query_cache_set_dirty(slurmdbd_conn);
+	if (committed || (msg->msg_type == DBD_FINI))
+		query_cache_committed(slurmdbd_conn);
+
+end_it:
 	/*
 	 * Clear DONT_UPDATE flag now so that it's tied to this transaction
 	 * only. Can't clear in p_commit() because if CommitDelay is set, we may
@@ -3739,6 +3944,11 @@ extern int proc_req(void *conn, persist_msg_t *msg, buf_t **out_buffer)
 
 	slurm_mutex_lock(&rpc_mutex);
 
+	if (cache_hit)
+		rpc_stats.query_cache_hits++;
+	else if (cache_miss)
+		rpc_stats.query_cache_misses++;
+
 	if (!(rpc_obj = list_find_first(rpc_stats.rpc_list,
 					_find_rpc_obj_in_list,
 					&msg->msg_type))) {
@@ -47,6 +47,8 @@ typedef struct {
 	slurm_persist_conn_t *conn;
 	slurm_persist_conn_t *conn_send;
 	void *db_conn; /* database connection */
+	bool in_mult_msg; /* processing the messages of a DBD_SEND_MULT_MSG */
+	bool query_cache_dirty; /* uncommitted changes, see query_cache.h */
 	char *tres_str;
 } slurmdbd_conn_t;
 
@@ -60,4 +62,7 @@ typedef struct {
  * RET SLURM_SUCCESS or error code */
 extern int proc_req(void *conn, persist_msg_t *msg, buf_t **out_buffer);
 
+/* Apply a reconfigure to the queries waiting for MaxQueryThreads */
+extern void proc_req_reconfig(void);
+
 #endif /* !_PROC_REQ */
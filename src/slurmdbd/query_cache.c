@@ -0,0 +1,288 @@
+/*****************************************************************************\
+ *  query_cache.c - cache of replies to repeated slurmdbd queries.
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/slurmdbd_defs.h"
+#include "src/common/slurmdbd_pack.h"
+#include "src/common/xhash.h"
+#include "src/common/xmalloc.h"
+#include "src/slurmdbd/query_cache.h"
+
+#define QUERY_CACHE_MAX_ENTRIES 256
+#define QUERY_CACHE_MAX_SIZE (256 * 1024 * 1024) /* bytes of all replies */
+#define QUERY_CACHE_TTL 300 /* seconds a reply is used for at most */
+
+struct query_cache_key {
+	buf_t *buffer; /* packed request, protocol version and uid */
+	uint64_t generation; /* cache generation at lookup */
+};
+
+typedef struct {
+	query_cache_key_t *key;
+	buf_t *reply;
+	time_t time;
+} query_cache_entry_t;
+
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static list_t *cache_list = NULL; /* query_cache_entry_t, oldest first */
+static xhash_t *cache_hash = NULL; /* index of cache_list by key */
+static uint64_t cache_size = 0;
+static uint64_t generation = 0;
+
+static void _entry_hash_id(void *item, const char **key, uint32_t *key_len)
+{
+	query_cache_entry_t *entry = item;
+
+	*key = get_buf_data(entry->key->buffer);
+	*key_len = get_buf_offset(entry->key->buffer);
+}
+
+static void _free_entry(void *x)
+{
+	query_cache_entry_t *entry = x;
+
+	query_cache_free_key(&entry->key);
+	FREE_NULL_BUFFER(entry->reply);
+	xfree(entry);
+}
+
+static buf_t *_copy_buf(buf_t *buffer)
+{
+	uint32_t size = get_buf_offset(buffer);
+	buf_t *copy = init_buf(size);
+
+	memcpy(get_buf_data(copy), get_buf_data(buffer), size);
+	set_buf_offset(copy, size);
+
+	return copy;
+}
+
+/* NOTE: cache_lock must be locked before calling */
+static void _remove_oldest(void)
+{
+	query_cache_entry_t *entry = list_dequeue(cache_list);
+
+	xhash_delete(cache_hash, get_buf_data(entry->key->buffer),
+		     get_buf_offset(entry->key->buffer));
+	cache_size -= get_buf_offset(entry->reply);
+	_free_entry(entry);
+}
+
+/* NOTE: cache_lock must be locked before calling */
+static void _remove_entry(query_cache_entry_t *entry)
+{
+	xhash_delete(cache_hash, get_buf_data(entry->key->buffer),
+		     get_buf_offset(entry->key->buffer));
+	cache_size -= get_buf_offset(entry->reply);
+	list_delete_ptr(cache_list, entry);
+}
+
+static bool _cacheable(slurmdbd_msg_type_t msg_type)
+{
+	switch (msg_type) {
+	case DBD_GET_ASSOCS:
+	case DBD_GET_ASSOC_USAGE:
+	case DBD_GET_CLUSTERS:
+	case DBD_GET_CLUSTER_USAGE:
+	case DBD_GET_WCKEY_USAGE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+extern bool query_cache_get(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
+			    query_cache_key_t **key, buf_t **out_buffer)
+{
+	query_cache_entry_t *entry;
+	buf_t *buffer;
+	bool found = false;
+
+	*key = NULL;
+
+	if (!_cacheable(msg->msg_type))
+		return false;
+
+	/*
+	 * Packing the request again gives the same bytes for equal
+	 * conditions. Replies depend on who asks and are packed for the
+	 * version of the connection, so both are part of the key.
+	 */
+	if (!(buffer = pack_slurmdbd_msg(msg, slurmdbd_conn->conn->version)))
+		return false;
+	pack16(slurmdbd_conn->conn->version, buffer);
+	pack32(slurmdbd_conn->conn->auth_uid, buffer);
+
+	slurm_mutex_lock(&cache_lock);
+	/* Replies could differ from what others see until committed */
+	if (slurmdbd_conn->query_cache_dirty) {
+		slurm_mutex_unlock(&cache_lock);
+		FREE_NULL_BUFFER(buffer);
+		return false;
+	}
+
+	if (!cache_list) {
+		cache_list = list_create(_free_entry);
+		cache_hash = xhash_init(_entry_hash_id, NULL);
+	}
+
+	if ((entry = xhash_get(cache_hash, get_buf_data(buffer),
+			       get_buf_offset(buffer)))) {
+		if ((entry->time + QUERY_CACHE_TTL) < time(NULL)) {
+			_remove_entry(entry);
+		} else {
+			*out_buffer = _copy_buf(entry->reply);
+			found = true;
+		}
+	}
+
+	if (!found) {
+		*key = xmalloc(sizeof(**key));
+		(*key)->buffer = buffer;
+		(*key)->generation = generation;
+		buffer = NULL;
+	}
+	slurm_mutex_unlock(&cache_lock);
+
+	FREE_NULL_BUFFER(buffer);
+
+	return found;
+}
+
+extern void query_cache_add(slurmdbd_conn_t *slurmdbd_conn,
+			    query_cache_key_t **key, buf_t *reply)
+{
+	query_cache_entry_t *entry;
+	uint32_t size = get_buf_offset(reply);
+
+	if (size > (QUERY_CACHE_MAX_SIZE / 4)) {
+		query_cache_free_key(key);
+		return;
+	}
+
+	slurm_mutex_lock(&cache_lock);
+	if (slurmdbd_conn->query_cache_dirty ||
+	    ((*key)->generation != generation) ||
+	    xhash_get(cache_hash, get_buf_data((*key)->buffer),
+		      get_buf_offset((*key)->buffer))) {
+		slurm_mutex_unlock(&cache_lock);
+		query_cache_free_key(key);
+		return;
+	}
+
+	while ((list_count(cache_list) >= QUERY_CACHE_MAX_ENTRIES) ||
+	       (list_count(cache_list) &&
+		((cache_size + size) > QUERY_CACHE_MAX_SIZE)))
+		_remove_oldest();
+
+	entry = xmalloc(sizeof(*entry));
+	entry->key = *key;
+	entry->reply = _copy_buf(reply);
+	entry->time = time(NULL);
+	list_enqueue(cache_list, entry);
+	xhash_add(cache_hash, entry);
+	cache_size += size;
+	slurm_mutex_unlock(&cache_lock);
+
+	*key = NULL;
+}
+
+extern void query_cache_free_key(query_cache_key_t **key)
+{
+	if (!*key)
+		return;
+
+	FREE_NULL_BUFFER((*key)->buffer);
+	xfree(*key);
+}
+
+/* NOTE: cache_lock must be locked before calling */
+static void _invalidate(void)
+{
+	generation++;
+	if (cache_list && list_count(cache_list)) {
+		log_flag(DB_QUERY, "%s: dropping %d cached replies",
+			 __func__, list_count(cache_list));
+		xhash_clear(cache_hash);
+		list_flush(cache_list);
+		cache_size = 0;
+	}
+}
+
+extern void query_cache_invalidate(void)
+{
+	slurm_mutex_lock(&cache_lock);
+	_invalidate();
+	slurm_mutex_unlock(&cache_lock);
+}
+
+extern void query_cache_set_dirty(slurmdbd_conn_t *slurmdbd_conn)
+{
+	slurm_mutex_lock(&cache_lock);
+	slurmdbd_conn->query_cache_dirty = true;
+	slurm_mutex_unlock(&cache_lock);
+}
+
+extern void query_cache_committed(slurmdbd_conn_t *slurmdbd_conn)
+{
+	slurm_mutex_lock(&cache_lock);
+	if (slurmdbd_conn->query_cache_dirty) {
+		_invalidate();
+		slurmdbd_conn->query_cache_dirty = false;
+	}
+	slurm_mutex_unlock(&cache_lock);
+}
+
+extern uint32_t query_cache_count(void)
+{
+	uint32_t count = 0;
+
+	slurm_mutex_lock(&cache_lock);
+	if (cache_list)
+		count = list_count(cache_list);
+	slurm_mutex_unlock(&cache_lock);
+
+	return count;
+}
+
+extern void query_cache_fini(void)
+{
+	slurm_mutex_lock(&cache_lock);
+	xhash_free(cache_hash);
+	FREE_NULL_LIST(cache_list);
+	cache_size = 0;
+	slurm_mutex_unlock(&cache_lock);
+}
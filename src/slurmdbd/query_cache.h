@@ -0,0 +1,87 @@
+/*****************************************************************************\
+ *  query_cache.h - cache of replies to repeated slurmdbd queries.
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _QUERY_CACHE_H
+#define _QUERY_CACHE_H
+
+#include "src/common/pack.h"
+#include "src/common/slurm_persist_conn.h"
+#include "src/slurmdbd/proc_req.h"
+
+typedef struct query_cache_key query_cache_key_t;
+
+/*
+ * Look for a cached reply to msg. Nothing is looked up while the connection
+ * has uncommitted changes.
+ * IN slurmdbd_conn - connection msg came in on
+ * IN msg - request
+ * OUT key - set if msg can be cached but was not found. Pass it to
+ *	     query_cache_add() with the reply once processed.
+ * OUT out_buffer - copy of the cached reply if found
+ * RET true if found
+ */
+extern bool query_cache_get(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
+			    query_cache_key_t **key, buf_t **out_buffer);
+
+/*
+ * Remember the reply for a request not found by query_cache_get(). Nothing is
+ * stored if the cache was invalidated since the lookup or the connection has
+ * uncommitted changes the reply may include.
+ * IN slurmdbd_conn - connection the request came in on
+ * IN/OUT key - from query_cache_get(), freed and set to NULL
+ * IN reply - reply to the request, copied
+ */
+extern void query_cache_add(slurmdbd_conn_t *slurmdbd_conn,
+			    query_cache_key_t **key, buf_t *reply);
+
+/* Free a key from query_cache_get() without adding anything */
+extern void query_cache_free_key(query_cache_key_t **key);
+
+/* Forget all cached replies, call after any committed change they may cover */
+extern void query_cache_invalidate(void);
+
+/* Note the connection made changes cached replies may cover, not committed */
+extern void query_cache_set_dirty(slurmdbd_conn_t *slurmdbd_conn);
+
+/* The changes of the connection were committed, forget what they may cover */
+extern void query_cache_committed(slurmdbd_conn_t *slurmdbd_conn);
+
+/* Return the number of cached replies */
+extern uint32_t query_cache_count(void);
+
+/* Free all cached replies */
+extern void query_cache_fini(void);
+
+#endif /* !_QUERY_CACHE_H */
@@ -152,6 +152,7 @@ extern int read_slurmdbd_conf(void)
 		{"JobPurge", S_P_UINT32},
 		{"LogFile", S_P_STRING},
 		{"LogTimeFormat", S_P_STRING},
+		{"MaxQueryThreads", S_P_UINT16},
 		{"MaxQueryTimeRange", S_P_STRING},
 		{"MessageTimeout", S_P_UINT16},
 		{"Parameters", S_P_STRING},
@@ -371,6 +372,11 @@ extern int read_slurmdbd_conf(void)
 			xfree(temp_str);
 		}
 
+		if (!s_p_get_uint16(&slurmdbd_conf->max_query_threads,
+				    "MaxQueryThreads", tbl))
+			slurmdbd_conf->max_query_threads =
+				DEFAULT_SLURMDBD_MAX_QUERY_THREADS;
+
 		if (s_p_get_string(&temp_str, "MaxQueryTimeRange", tbl)) {
 			slurmdbd_conf->max_time_range = time_str2secs(temp_str);
 			xfree(temp_str);
@@ -892,6 +898,12 @@ extern List dump_config(void)
 	key_pair->value = xstrdup(slurmdbd_conf->log_file);
 	list_append(my_list, key_pair);
 
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("MaxQueryThreads");
+	key_pair->value = xstrdup_printf("%u",
+					 slurmdbd_conf->max_query_threads);
+	list_append(my_list, key_pair);
+
 	secs2time_str(slurmdbd_conf->max_time_range, time_str,
 		      sizeof(time_str));
 	key_pair = xmalloc(sizeof(config_key_pair_t));
@@ -53,6 +53,7 @@
 #define DEFAULT_SLURMDBD_KEEPALIVE_INTERVAL 30
 #define DEFAULT_SLURMDBD_KEEPALIVE_PROBES 3
 #define DEFAULT_SLURMDBD_KEEPALIVE_TIME 30
+#define DEFAULT_SLURMDBD_MAX_QUERY_THREADS 16
 //#define DEFAULT_SLURMDBD_STEP_PURGE	1
 
 /* Define slurmdbd_conf_t flags */
@@ -76,6 +77,8 @@ typedef struct {
 					 * adding clusters              */
 	uint32_t flags;			/* Various flags see DBD_CONF_FLAG_* */
 	char *		log_file;	/* Log file			*/
+	uint16_t	max_query_threads; /* max user queries run at once,
+					    * 0 is no limit		*/
 	uint32_t	max_time_range;	/* max time range for user queries */
 	char *		parameters;	/* parameters to change behavior with
 					 * the slurmdbd directly	*/
@@ -54,6 +54,7 @@
 #include "src/common/xmalloc.h"
 #include "src/common/xsignal.h"
 #include "src/slurmdbd/proc_req.h"
+#include "src/slurmdbd/query_cache.h"
 #include "src/slurmdbd/read_config.h"
 #include "src/slurmdbd/rpc_mgr.h"
 #include "src/slurmdbd/slurmdbd.h"
@@ -170,6 +171,7 @@ static void _connection_fini_callback(void *arg)
 
 		/* needs to be the last thing done */
 		acct_storage_g_commit(conn->db_conn, 1);
+		query_cache_invalidate();
 	}
 
 	acct_storage_g_close_connection(&conn->db_conn);
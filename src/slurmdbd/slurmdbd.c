@@ -72,6 +72,7 @@
 #include "src/slurmdbd/read_config.h"
 #include "src/slurmdbd/rpc_mgr.h"
 #include "src/slurmdbd/proc_req.h"
+#include "src/slurmdbd/query_cache.h"
 #include "src/slurmdbd/backup.h"
 
 /* Global variables */
@@ -274,6 +275,7 @@ int main(int argc, char **argv)
 
 		_request_registrations(db_conn);
 		acct_storage_g_commit(db_conn, 1);
+		query_cache_invalidate();
 
 		/* this is only ran if not backup */
 		slurm_thread_join(rollup_handler_thread);
@@ -322,6 +324,7 @@ end_it:
 	slurm_mutex_lock(&rpc_mutex);
 	slurmdb_free_stats_rec_members(&rpc_stats);
 	slurm_mutex_unlock(&rpc_mutex);
+	query_cache_fini();
 	exit(0);
 }
 
@@ -330,6 +333,7 @@ extern void reconfig(void)
 	read_slurmdbd_conf();
 	assoc_mgr_set_missing_uids();
 	acct_storage_g_reconfig(NULL, 0);
+	proc_req_reconfig();
 	_update_logging(false);
 }
 
@@ -750,6 +754,7 @@ static void *_rollup_handler(void *db_conn)
 		acct_storage_g_roll_usage(db_conn, 0, 0, 1, &rollup_stats_list);
 		END_TIMER;
 		acct_storage_g_commit(db_conn, 1);
+		query_cache_invalidate();
 		running_rollup = 0;
 
 		handle_rollup_stats(rollup_stats_list, DELTA_TIMER, 0);
@@ -815,6 +820,7 @@ static void *_commit_handler(void *db_conn)
 				       slurmdbd_conn->conn->cluster_name);
 				acct_storage_g_commit(
 					slurmdbd_conn->db_conn, 1);
+				query_cache_committed(slurmdbd_conn);
 			}
 			list_iterator_destroy(itr);
 			running_commit = 0;
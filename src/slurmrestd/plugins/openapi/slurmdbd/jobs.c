@@ -44,6 +44,8 @@
 #include "api.h"
 #include "src/slurmrestd/operations.h"
 
+#define JOBS_PAGE_SIZE 10000	/* jobs per reply from the slurmdbd */
+
 static void _dump_jobs(ctxt_t *ctxt, slurmdb_job_cond_t *job_cond)
 {
 	list_t *jobs = NULL;
@@ -58,6 +60,9 @@ static void _dump_jobs(ctxt_t *ctxt, slurmdb_job_cond_t *job_cond)
 			    xstrdup(slurm_conf.cluster_name));
 	}
 
+	if (job_cond)
+		job_cond->page_size = JOBS_PAGE_SIZE;
+
 	if (!db_query_list(ctxt, &jobs, slurmdb_jobs_get, job_cond))
 		DUMP_OPENAPI_RESP_SINGLE(OPENAPI_SLURMDBD_JOBS_RESP, jobs,
 					 ctxt);
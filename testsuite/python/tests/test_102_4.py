@@ -0,0 +1,217 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import atf
+import getpass
+import pytest
+
+# Two private MariaDB servers, the replica replicating from the primary
+primary = {"server_id": 1}
+replica = {"server_id": 2}
+
+cluster_name = "test-replica-cluster"
+account1 = "test-replica-acct1"
+account2 = "test-replica-acct2"
+account3 = "test-replica-acct3"
+
+read_max_lag = 5
+# READ_LAG_CHECK_INTERVAL in accounting_storage_mysql.c plus read_max_lag
+fallback_timeout = 10 + read_max_lag + 15
+
+
+def _tool(*names):
+    for name in names:
+        if atf.is_tool(name):
+            return name
+    pytest.skip(
+        f"This test requires one of {', '.join(names)}", allow_module_level=True
+    )
+
+
+def _sql(server, query, fatal=True):
+    return atf.run_command_output(
+        f'{mysql} --no-defaults -S {server["socket"]} -u root -N -B -e "{query}"',
+        fatal=fatal,
+        quiet=True,
+    )
+
+
+def _start_server(server, name):
+    datadir = atf.module_tmp_path / f"{name}_data"
+    server["socket"] = atf.module_tmp_path / f"{name}.sock"
+    server["pid_file"] = atf.module_tmp_path / f"{name}.pid"
+    server["port"] = atf.get_open_port()
+
+    atf.run_command(
+        f"{install_db} --no-defaults --user={getpass.getuser()} "
+        f"--datadir={datadir} --auth-root-authentication-method=normal",
+        fatal=True,
+    )
+
+    options = (
+        f"--no-defaults --user={getpass.getuser()} --datadir={datadir} "
+        f"--socket={server['socket']} --pid-file={server['pid_file']} "
+        f"--port={server['port']} --bind-address=127.0.0.1 "
+        f"--server-id={server['server_id']} --innodb-lock-wait-timeout=900"
+    )
+    if server is primary:
+        options += " --log-bin=mysql-bin --binlog-format=ROW"
+    else:
+        options += " --read-only"
+
+    atf.run_command(
+        f"nohup {mysqld} {options} > {atf.module_tmp_path / name}.log 2>&1 "
+        "< /dev/null &",
+        fatal=True,
+    )
+    atf.repeat_until(
+        lambda: atf.run_command_exit(
+            f"{mysqladmin} --no-defaults -S {server['socket']} -u root ping",
+            quiet=True,
+        ),
+        lambda exit_code: exit_code == 0,
+        fatal=True,
+    )
+
+
+def _stop_server(server):
+    if "pid_file" in server:
+        atf.run_command(f"kill $(cat {server['pid_file']})", quiet=True)
+
+
+def _set_replica_delay(delay):
+    _sql(replica, "STOP SLAVE")
+    _sql(replica, f"CHANGE MASTER TO MASTER_DELAY={delay}")
+    _sql(replica, "START SLAVE")
+
+
+def _replica_has_account(account):
+    return _sql(
+        replica, f"SELECT name FROM {storage_loc}.acct_table WHERE name='{account}'"
+    ).strip()
+
+
+def _assoc_account(account):
+    return atf.run_command_output(
+        f"sacctmgr -n -P show assoc where cluster={cluster_name} "
+        f"account={account} user= format=account",
+        user=atf.properties["slurm-user"],
+    ).strip()
+
+
+def _add_account(account):
+    atf.run_command(
+        f"sacctmgr -i add account {account} cluster={cluster_name}",
+        user=atf.properties["slurm-user"],
+        fatal=True,
+    )
+
+
+# Setup
+@pytest.fixture(scope="module", autouse=True)
+def setup(request):
+    global mysql, mysqld, mysqladmin, install_db, storage_loc
+
+    atf.require_auto_config(
+        "points the slurmdbd to private primary and replica databases"
+    )
+    atf.require_accounting()
+
+    mysqld = _tool("mariadbd", "mysqld")
+    install_db = _tool("mariadb-install-db", "mysql_install_db")
+    mysql = _tool("mariadb", "mysql")
+    mysqladmin = _tool("mariadb-admin", "mysqladmin")
+
+    request.addfinalizer(lambda: _stop_server(replica))
+    request.addfinalizer(lambda: _stop_server(primary))
+    _start_server(primary, "primary")
+    _start_server(replica, "replica")
+
+    # Replicate everything done on the primary from now on
+    _sql(primary, "CREATE USER 'repl'@'%' IDENTIFIED BY 'repl'")
+    _sql(primary, "GRANT REPLICATION SLAVE ON *.* TO 'repl'@'%'")
+    log_file, log_pos = _sql(primary, "SHOW MASTER STATUS").split()[:2]
+    _sql(
+        replica,
+        f"CHANGE MASTER TO MASTER_HOST='127.0.0.1', "
+        f"MASTER_PORT={primary['port']}, MASTER_USER='repl', "
+        f"MASTER_PASSWORD='repl', MASTER_LOG_FILE='{log_file}', "
+        f"MASTER_LOG_POS={log_pos}",
+    )
+    _sql(replica, "START SLAVE")
+
+    slurmdbd_dict = atf.get_config(live=False, source="slurmdbd", quiet=True)
+    storage_user = slurmdbd_dict.get("StorageUser", "slurm")
+    storage_pass = slurmdbd_dict.get("StoragePass", "")
+    storage_loc = slurmdbd_dict.get("StorageLoc", "slurm_acct_db")
+    _sql(primary, f"CREATE USER '{storage_user}'@'%' IDENTIFIED BY '{storage_pass}'")
+    _sql(primary, f"GRANT ALL ON *.* TO '{storage_user}'@'%'")
+
+    atf.require_config_parameter("StorageHost", "127.0.0.1", source="slurmdbd")
+    atf.require_config_parameter("StoragePort", primary["port"], source="slurmdbd")
+    atf.require_config_parameter(
+        "StorageParameters",
+        f"READ_HOST=127.0.0.1,READ_PORT={replica['port']},"
+        f"READ_MAX_LAG={read_max_lag}",
+        source="slurmdbd",
+    )
+    atf.require_slurm_running()
+
+    atf.run_command(
+        f"sacctmgr -i add cluster {cluster_name}",
+        user=atf.properties["slurm-user"],
+        fatal=True,
+    )
+
+
+def test_replica_in_sync():
+    """Verify associations are read while the replica keeps up"""
+
+    _add_account(account1)
+    assert atf.repeat_until(
+        lambda: _replica_has_account(account1),
+        lambda name: name == account1,
+    ), "The account was not replicated"
+    assert _assoc_account(account1) == account1
+
+
+def test_replication_stopped():
+    """Verify reads go back to the primary when replication stops"""
+
+    _sql(replica, "STOP SLAVE SQL_THREAD")
+    _add_account(account2)
+
+    assert atf.repeat_until(
+        lambda: _assoc_account(account2),
+        lambda name: name == account2,
+        timeout=fallback_timeout,
+    ), "The new association was not read from the primary"
+    assert _replica_has_account(account2) == "", "The replica should be stopped"
+
+    _sql(replica, "START SLAVE SQL_THREAD")
+    assert atf.repeat_until(
+        lambda: _replica_has_account(account2),
+        lambda name: name == account2,
+    ), "The replica did not catch up"
+    assert _assoc_account(account2) == account2
+
+
+def test_replica_lagging():
+    """Verify reads go back to the primary when the replica lags too much"""
+
+    _set_replica_delay(60)
+    _add_account(account3)
+
+    assert atf.repeat_until(
+        lambda: _assoc_account(account3),
+        lambda name: name == account3,
+        timeout=fallback_timeout,
+    ), "The new association was not read from the primary"
+    assert _replica_has_account(account3) == "", "The replica should be lagging"
+
+    _set_replica_delay(0)
+    assert atf.repeat_until(
+        lambda: _replica_has_account(account3),
+        lambda name: name == account3,
+    ), "The replica did not catch up"
+    assert _assoc_account(account3) == account3